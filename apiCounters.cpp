@@ -0,0 +1,330 @@
+#include "apiCounters.hpp"
+#include <atomic>
+#include <vulkan/vulkan_core.h>
+
+#ifdef TRIANGLE_API_COUNTERS_ENABLED
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#endif
+
+namespace {
+
+struct atomicCounts {
+	std::atomic<uint64_t> commands{0};
+	std::atomic<uint64_t> draws{0};
+	std::atomic<uint64_t> dispatches{0};
+	std::atomic<uint64_t> barriers{0};
+	std::atomic<uint64_t> submits{0};
+	std::atomic<uint64_t> descriptorUpdates{0};
+	std::atomic<uint64_t> allocations{0};
+	std::atomic<uint64_t> copyBytes{0};
+};
+
+atomicCounts counted;
+
+// workers record secondaries at the same time as the render thread, relaxed is enough since take only runs between frames
+void add(std::atomic<uint64_t> &counter, uint64_t amount = 1) { counter.fetch_add(amount, std::memory_order_relaxed); }
+
+} // namespace
+
+bool tapi::compiledIn()
+{
+#ifdef TRIANGLE_API_COUNTERS_ENABLED
+	return true;
+#else
+	return false;
+#endif
+}
+
+tapi::callCounts tapi::take()
+{
+	callCounts taken;
+	taken.commands = counted.commands.exchange(0, std::memory_order_relaxed);
+	taken.draws = counted.draws.exchange(0, std::memory_order_relaxed);
+	taken.dispatches = counted.dispatches.exchange(0, std::memory_order_relaxed);
+	taken.barriers = counted.barriers.exchange(0, std::memory_order_relaxed);
+	taken.submits = counted.submits.exchange(0, std::memory_order_relaxed);
+	taken.descriptorUpdates = counted.descriptorUpdates.exchange(0, std::memory_order_relaxed);
+	taken.allocations = counted.allocations.exchange(0, std::memory_order_relaxed);
+	taken.copyBytes = counted.copyBytes.exchange(0, std::memory_order_relaxed);
+	return taken;
+}
+
+bool tapi::operator==(const callCounts &a, const callCounts &b)
+{
+	return a.commands == b.commands && a.draws == b.draws && a.dispatches == b.dispatches && a.barriers == b.barriers && a.submits == b.submits &&
+	       a.descriptorUpdates == b.descriptorUpdates && a.allocations == b.allocations && a.copyBytes == b.copyBytes;
+}
+
+bool tapi::operator!=(const callCounts &a, const callCounts &b) { return !(a == b); }
+
+void tapi::print(std::ostream &out, const callCounts &counts, uint64_t frames)
+{
+	frames = frames == 0 ? 1 : frames;
+	auto perFrame = [frames](uint64_t total) { return static_cast<double>(total) / frames; };
+	out << perFrame(counts.commands) << " commands (" << perFrame(counts.draws) << " draws, " << perFrame(counts.dispatches) << " dispatches, "
+	    << perFrame(counts.barriers) << " barriers), " << perFrame(counts.submits) << " submits, " << perFrame(counts.descriptorUpdates)
+	    << " descriptor updates, " << perFrame(counts.allocations) << " allocations, " << perFrame(counts.copyBytes) << " bytes copied";
+}
+
+#ifdef TRIANGLE_API_COUNTERS_ENABLED
+
+// the loaders version of an entry point, there is nothing sensible to do without it
+static void *nextFunction(const char *name)
+{
+	void *function = dlsym(RTLD_NEXT, name);
+	if (function == nullptr) {
+		std::fprintf(stderr, "api counters: %s is not exported by the vulkan loader\n", name);
+		std::abort();
+	}
+	return function;
+}
+
+#define FORWARD(name, ...)                                                                                                                           \
+	static const auto next = reinterpret_cast<PFN_##name>(nextFunction(#name));                                                                \
+	return next(__VA_ARGS__)
+
+// extension functions come from vkGetDeviceProcAddr, the real pointers are kept here once they were looked up
+static std::atomic<PFN_vkCmdPipelineBarrier2KHR> nextPipelineBarrier2{nullptr};
+static std::atomic<PFN_vkCmdBeginRenderingKHR> nextBeginRendering{nullptr};
+static std::atomic<PFN_vkCmdEndRenderingKHR> nextEndRendering{nullptr};
+
+static VKAPI_ATTR void VKAPI_CALL countPipelineBarrier2(VkCommandBuffer commandBuffer, const VkDependencyInfo *dependencyInfo)
+{
+	add(counted.commands);
+	add(counted.barriers);
+	nextPipelineBarrier2.load(std::memory_order_relaxed)(commandBuffer, dependencyInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL countBeginRendering(VkCommandBuffer commandBuffer, const VkRenderingInfo *renderingInfo)
+{
+	add(counted.commands);
+	nextBeginRendering.load(std::memory_order_relaxed)(commandBuffer, renderingInfo);
+}
+
+static VKAPI_ATTR void VKAPI_CALL countEndRendering(VkCommandBuffer commandBuffer)
+{
+	add(counted.commands);
+	nextEndRendering.load(std::memory_order_relaxed)(commandBuffer);
+}
+
+extern "C" {
+
+VKAPI_ATTR PFN_vkVoidFunction VKAPI_CALL vkGetDeviceProcAddr(VkDevice device, const char *name)
+{
+	static const auto next = reinterpret_cast<PFN_vkGetDeviceProcAddr>(nextFunction("vkGetDeviceProcAddr"));
+	PFN_vkVoidFunction function = next(device, name);
+	if (function == nullptr)
+		return nullptr;
+	if (std::strcmp(name, "vkCmdPipelineBarrier2KHR") == 0) {
+		nextPipelineBarrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2KHR>(function);
+		return reinterpret_cast<PFN_vkVoidFunction>(countPipelineBarrier2);
+	}
+	if (std::strcmp(name, "vkCmdBeginRenderingKHR") == 0) {
+		nextBeginRendering = reinterpret_cast<PFN_vkCmdBeginRenderingKHR>(function);
+		return reinterpret_cast<PFN_vkVoidFunction>(countBeginRendering);
+	}
+	if (std::strcmp(name, "vkCmdEndRenderingKHR") == 0) {
+		nextEndRendering = reinterpret_cast<PFN_vkCmdEndRenderingKHR>(function);
+		return reinterpret_cast<PFN_vkVoidFunction>(countEndRendering);
+	}
+	return function;
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkQueueSubmit(VkQueue queue, uint32_t submitCount, const VkSubmitInfo *submits, VkFence fence)
+{
+	add(counted.submits);
+	FORWARD(vkQueueSubmit, queue, submitCount, submits, fence);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkUpdateDescriptorSets(VkDevice device, uint32_t writeCount, const VkWriteDescriptorSet *writes, uint32_t copyCount,
+						  const VkCopyDescriptorSet *copies)
+{
+	add(counted.descriptorUpdates);
+	FORWARD(vkUpdateDescriptorSets, device, writeCount, writes, copyCount, copies);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo *allocateInfo, const VkAllocationCallbacks *allocator,
+						VkDeviceMemory *memory)
+{
+	add(counted.allocations);
+	FORWARD(vkAllocateMemory, device, allocateInfo, allocator, memory);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateCommandBuffers(VkDevice device, const VkCommandBufferAllocateInfo *allocateInfo, VkCommandBuffer *commandBuffers)
+{
+	add(counted.allocations);
+	FORWARD(vkAllocateCommandBuffers, device, allocateInfo, commandBuffers);
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateDescriptorSets(VkDevice device, const VkDescriptorSetAllocateInfo *allocateInfo, VkDescriptorSet *sets)
+{
+	add(counted.allocations);
+	FORWARD(vkAllocateDescriptorSets, device, allocateInfo, sets);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDraw(VkCommandBuffer commandBuffer, uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex,
+				     uint32_t firstInstance)
+{
+	add(counted.commands);
+	add(counted.draws);
+	FORWARD(vkCmdDraw, commandBuffer, vertexCount, instanceCount, firstVertex, firstInstance);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDrawIndexed(VkCommandBuffer commandBuffer, uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex,
+					    int32_t vertexOffset, uint32_t firstInstance)
+{
+	add(counted.commands);
+	add(counted.draws);
+	FORWARD(vkCmdDrawIndexed, commandBuffer, indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdDispatch(VkCommandBuffer commandBuffer, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+{
+	add(counted.commands);
+	add(counted.dispatches);
+	FORWARD(vkCmdDispatch, commandBuffer, groupCountX, groupCountY, groupCountZ);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPipelineBarrier(VkCommandBuffer commandBuffer, VkPipelineStageFlags srcStageMask, VkPipelineStageFlags dstStageMask,
+						VkDependencyFlags dependencyFlags, uint32_t memoryBarrierCount, const VkMemoryBarrier *memoryBarriers,
+						uint32_t bufferMemoryBarrierCount, const VkBufferMemoryBarrier *bufferMemoryBarriers,
+						uint32_t imageMemoryBarrierCount, const VkImageMemoryBarrier *imageMemoryBarriers)
+{
+	add(counted.commands);
+	add(counted.barriers);
+	FORWARD(vkCmdPipelineBarrier, commandBuffer, srcStageMask, dstStageMask, dependencyFlags, memoryBarrierCount, memoryBarriers,
+		bufferMemoryBarrierCount, bufferMemoryBarriers, imageMemoryBarrierCount, imageMemoryBarriers);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBuffer(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkBuffer dstBuffer, uint32_t regionCount,
+					   const VkBufferCopy *regions)
+{
+	add(counted.commands);
+	for (uint32_t i = 0; i < regionCount; ++i) {
+		add(counted.copyBytes, regions[i].size);
+	}
+	FORWARD(vkCmdCopyBuffer, commandBuffer, srcBuffer, dstBuffer, regionCount, regions);
+}
+
+// the image format isnt known here, every image this app uploads is 4 bytes per texel
+VKAPI_ATTR void VKAPI_CALL vkCmdCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer srcBuffer, VkImage dstImage, VkImageLayout dstImageLayout,
+						  uint32_t regionCount, const VkBufferImageCopy *regions)
+{
+	add(counted.commands);
+	for (uint32_t i = 0; i < regionCount; ++i) {
+		const VkExtent3D &extent = regions[i].imageExtent;
+		add(counted.copyBytes, uint64_t(4) * extent.width * extent.height * extent.depth * regions[i].imageSubresource.layerCount);
+	}
+	FORWARD(vkCmdCopyBufferToImage, commandBuffer, srcBuffer, dstImage, dstImageLayout, regionCount, regions);
+}
+
+// the rest only count as commands
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBeginQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query, VkQueryControlFlags flags)
+{
+	add(counted.commands);
+	FORWARD(vkCmdBeginQuery, commandBuffer, queryPool, query, flags);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdEndQuery(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t query)
+{
+	add(counted.commands);
+	FORWARD(vkCmdEndQuery, commandBuffer, queryPool, query);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdResetQueryPool(VkCommandBuffer commandBuffer, VkQueryPool queryPool, uint32_t firstQuery, uint32_t queryCount)
+{
+	add(counted.commands);
+	FORWARD(vkCmdResetQueryPool, commandBuffer, queryPool, firstQuery, queryCount);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdWriteTimestamp(VkCommandBuffer commandBuffer, VkPipelineStageFlagBits pipelineStage, VkQueryPool queryPool, uint32_t query)
+{
+	add(counted.commands);
+	FORWARD(vkCmdWriteTimestamp, commandBuffer, pipelineStage, queryPool, query);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBeginRenderPass(VkCommandBuffer commandBuffer, const VkRenderPassBeginInfo *renderPassBegin, VkSubpassContents contents)
+{
+	add(counted.commands);
+	FORWARD(vkCmdBeginRenderPass, commandBuffer, renderPassBegin, contents);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdEndRenderPass(VkCommandBuffer commandBuffer)
+{
+	add(counted.commands);
+	FORWARD(vkCmdEndRenderPass, commandBuffer);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdExecuteCommands(VkCommandBuffer commandBuffer, uint32_t commandBufferCount, const VkCommandBuffer *commandBuffers)
+{
+	add(counted.commands);
+	FORWARD(vkCmdExecuteCommands, commandBuffer, commandBufferCount, commandBuffers);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindPipeline(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline)
+{
+	add(counted.commands);
+	FORWARD(vkCmdBindPipeline, commandBuffer, pipelineBindPoint, pipeline);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindDescriptorSets(VkCommandBuffer commandBuffer, VkPipelineBindPoint pipelineBindPoint, VkPipelineLayout layout,
+						   uint32_t firstSet, uint32_t descriptorSetCount, const VkDescriptorSet *descriptorSets,
+						   uint32_t dynamicOffsetCount, const uint32_t *dynamicOffsets)
+{
+	add(counted.commands);
+	FORWARD(vkCmdBindDescriptorSets, commandBuffer, pipelineBindPoint, layout, firstSet, descriptorSetCount, descriptorSets, dynamicOffsetCount,
+		dynamicOffsets);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindVertexBuffers(VkCommandBuffer commandBuffer, uint32_t firstBinding, uint32_t bindingCount, const VkBuffer *buffers,
+						  const VkDeviceSize *offsets)
+{
+	add(counted.commands);
+	FORWARD(vkCmdBindVertexBuffers, commandBuffer, firstBinding, bindingCount, buffers, offsets);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBindIndexBuffer(VkCommandBuffer commandBuffer, VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	add(counted.commands);
+	FORWARD(vkCmdBindIndexBuffer, commandBuffer, buffer, offset, indexType);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdPushConstants(VkCommandBuffer commandBuffer, VkPipelineLayout layout, VkShaderStageFlags stageFlags, uint32_t offset,
+					      uint32_t size, const void *values)
+{
+	add(counted.commands);
+	FORWARD(vkCmdPushConstants, commandBuffer, layout, stageFlags, offset, size, values);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetViewport(VkCommandBuffer commandBuffer, uint32_t firstViewport, uint32_t viewportCount, const VkViewport *viewports)
+{
+	add(counted.commands);
+	FORWARD(vkCmdSetViewport, commandBuffer, firstViewport, viewportCount, viewports);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdSetScissor(VkCommandBuffer commandBuffer, uint32_t firstScissor, uint32_t scissorCount, const VkRect2D *scissors)
+{
+	add(counted.commands);
+	FORWARD(vkCmdSetScissor, commandBuffer, firstScissor, scissorCount, scissors);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdBlitImage(VkCommandBuffer commandBuffer, VkImage srcImage, VkImageLayout srcImageLayout, VkImage dstImage,
+					  VkImageLayout dstImageLayout, uint32_t regionCount, const VkImageBlit *regions, VkFilter filter)
+{
+	add(counted.commands);
+	FORWARD(vkCmdBlitImage, commandBuffer, srcImage, srcImageLayout, dstImage, dstImageLayout, regionCount, regions, filter);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkCmdFillBuffer(VkCommandBuffer commandBuffer, VkBuffer dstBuffer, VkDeviceSize dstOffset, VkDeviceSize size, uint32_t data)
+{
+	add(counted.commands);
+	FORWARD(vkCmdFillBuffer, commandBuffer, dstBuffer, dstOffset, size, data);
+}
+
+} // extern "C"
+
+#endif
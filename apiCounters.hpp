@@ -0,0 +1,33 @@
+#ifndef TRIANGLE_API_COUNTERS_HEADER
+#define TRIANGLE_API_COUNTERS_HEADER
+
+#include <cstdint>
+#include <ostream>
+
+// counts vulkan calls made by this process. built with TRIANGLE_API_COUNTERS_ENABLED the executable defines the vulkan
+// entry points it uses itself, counts each call and forwards it to the loader found with RTLD_NEXT. extension functions
+// are caught by handing out the counting versions from vkGetDeviceProcAddr. without it everything stays zero
+namespace tapi {
+
+struct callCounts {
+	uint64_t commands = 0; // every vkCmd* call, draws and barriers included
+	uint64_t draws = 0;
+	uint64_t dispatches = 0;
+	uint64_t barriers = 0; // barrier calls, however many barriers each one has
+	uint64_t submits = 0;
+	uint64_t descriptorUpdates = 0; // vkUpdateDescriptorSets calls
+	uint64_t allocations = 0;	// device memory, command buffers and descriptor sets
+	uint64_t copyBytes = 0;		// buffer copies and buffer to image copies
+};
+
+bool compiledIn();
+// everything counted since the last take, from every thread
+callCounts take();
+bool operator==(const callCounts &a, const callCounts &b);
+bool operator!=(const callCounts &a, const callCounts &b);
+// per frame averages over frames
+void print(std::ostream &out, const callCounts &counts, uint64_t frames);
+
+} // namespace tapi
+
+#endif
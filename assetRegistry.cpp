@@ -0,0 +1,115 @@
+#include "assetRegistry.hpp"
+#include "profiler.hpp"
+#include "trace.hpp"
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+// memcpy so unaligned input is fine, x86 is little endian so no byte swapping
+inline uint64_t read64(const uint8_t *p)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline uint32_t read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+inline uint64_t round(uint64_t acc, uint64_t input)
+{
+	acc += input * PRIME2;
+	acc = rotl(acc, 31);
+	return acc * PRIME1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t val)
+{
+	acc ^= round(0, val);
+	return acc * PRIME1 + PRIME4;
+}
+
+} // namespace
+
+uint64_t tasset::hash64(const void *data, size_t size, uint64_t seed)
+{
+	const uint8_t *p = static_cast<const uint8_t *>(data);
+	const uint8_t *end = p + size;
+	uint64_t h;
+
+	// 4 independent lanes over 32 byte stripes, thats what makes it fast enough to hash every asset on load
+	if (size >= 32) {
+		uint64_t v1 = seed + PRIME1 + PRIME2;
+		uint64_t v2 = seed + PRIME2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - PRIME1;
+		const uint8_t *limit = end - 32;
+		do {
+			v1 = round(v1, read64(p));
+			v2 = round(v2, read64(p + 8));
+			v3 = round(v3, read64(p + 16));
+			v4 = round(v4, read64(p + 24));
+			p += 32;
+		} while (p <= limit);
+
+		h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+		h = mergeRound(h, v1);
+		h = mergeRound(h, v2);
+		h = mergeRound(h, v3);
+		h = mergeRound(h, v4);
+	} else {
+		h = seed + PRIME5;
+	}
+
+	h += static_cast<uint64_t>(size);
+
+	for (; p + 8 <= end; p += 8) {
+		h ^= round(0, read64(p));
+		h = rotl(h, 27) * PRIME1 + PRIME4;
+	}
+	if (p + 4 <= end) {
+		h ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+		h = rotl(h, 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	for (; p < end; ++p) {
+		h ^= (*p) * PRIME5;
+		h = rotl(h, 11) * PRIME1;
+	}
+
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+std::vector<uint8_t> tasset::readFile(const std::string &path)
+{
+	tprofile::Scope scope("read asset", tprofile::kind::fileIo);
+	TRACE_ZONE("read asset");
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		throw std::runtime_error(std::string("failed to open asset ").append(path));
+	}
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	std::vector<uint8_t> buffer(fileSize);
+	file.seekg(0);
+	file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(fileSize));
+	return buffer;
+}
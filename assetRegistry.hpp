@@ -0,0 +1,75 @@
+#ifndef TRIANGLE_ASSET_REGISTRY_HEADER
+#define TRIANGLE_ASSET_REGISTRY_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// assets are keyed by a hash of the file contents instead of the path, so the same image or mesh showing up
+// under two paths (or as two copies) is decoded and uploaded once and shared with a reference count
+namespace tasset {
+
+typedef uint64_t assetKey;
+
+// xxHash64 of data, same output as the reference implementation
+uint64_t hash64(const void *data, size_t size, uint64_t seed = 0);
+
+// whole file as raw bytes, throws if it cant be read
+std::vector<uint8_t> readFile(const std::string &path);
+
+// owns nothing on the gpu itself, it only tracks who uses what. the caller creates the resource on a miss and
+// destroys it when release says the last reference is gone, since only the caller knows how
+template <typename Resource> class Registry {
+      public:
+	// returns the loaded resource and takes a reference to it, nullptr if nothing with that content is loaded yet
+	Resource *acquire(assetKey key)
+	{
+		auto it = entries.find(key);
+		if (it == entries.end()) {
+			++misses;
+			return nullptr;
+		}
+		++hits;
+		++it->second.refCount;
+		return &it->second.resource;
+	}
+
+	// adds a freshly created resource with one reference, pointers stay valid until the entry is released
+	Resource *insert(assetKey key, const Resource &resource)
+	{
+		entry &e = entries[key];
+		e.resource = resource;
+		e.refCount = 1;
+		return &e.resource;
+	}
+
+	// drops a reference, returns true and hands the resource back when that was the last one
+	bool release(assetKey key, Resource &released)
+	{
+		auto it = entries.find(key);
+		if (it == entries.end() || --it->second.refCount > 0)
+			return false;
+		released = it->second.resource;
+		entries.erase(it);
+		return true;
+	}
+
+	size_t size() const { return entries.size(); }
+	uint32_t hitCount() const { return hits; }
+	uint32_t missCount() const { return misses; }
+
+      private:
+	struct entry {
+		Resource resource;
+		uint32_t refCount;
+	};
+	std::unordered_map<assetKey, entry> entries;
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+};
+
+} // namespace tasset
+
+#endif
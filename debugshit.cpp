@@ -1,12 +1,128 @@
 #include "debugshit.hpp"
+#include "mpscQueue.hpp"
+#include "profiler.hpp"
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
+#include <thread>
+#include <unordered_map>
 #include <vulkan/vulkan_core.h>
 
+// messages the callbacks can get ahead of the printing thread by, past that they are dropped and counted
+static const size_t MESSAGE_QUEUE_CAPACITY = 1024;
+// how long the printing thread sleeps when the queue is empty
+static const std::chrono::milliseconds MESSAGE_POLL_INTERVAL(2);
+
+namespace {
+
+struct validationMessage {
+	VkDebugUtilsMessageSeverityFlagBitsEXT severity;
+	VkDebugUtilsMessageTypeFlagsEXT type;
+	int32_t id;
+	std::string idName;
+	std::string text;
+};
+
+// everything the printing thread knows about one message id
+struct seenMessage {
+	uint32_t count;
+	bool performance;
+	std::string idName;
+	std::string text; // only kept for the performance report
+};
+
+struct messagePipeline {
+	tqueue::MpscQueue<validationMessage, MESSAGE_QUEUE_CAPACITY> queue;
+	std::atomic<uint32_t> minimumSeverity{VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT};
+	std::atomic<uint32_t> types{VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT |
+				    VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT};
+	std::atomic<uint64_t> dropped{0};
+	std::atomic<uint64_t> filtered{0};
+	std::atomic<bool> running{false};
+	std::thread thread;
+	// printing thread only
+	std::unordered_map<uint64_t, seenMessage> seen;
+	uint64_t printed = 0;
+	uint64_t folded = 0;
+
+	// anything still running at exit (run threw) is joined here, the report is skipped then
+	~messagePipeline()
+	{
+		running = false;
+		if (thread.joinable())
+			thread.join();
+	}
+};
+
+messagePipeline pipeline;
+
+const char *severityName(VkDebugUtilsMessageSeverityFlagBitsEXT severity)
+{
+	switch (severity) {
+	case VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT:
+		return "verbose";
+	case VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT:
+		return "info";
+	case VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT:
+		return "warning";
+	default:
+		return "error";
+	}
+}
+
+// ids are 32 bit, messages without one (some loader and general ones) are told apart by their text in the upper half
+uint64_t messageKey(const validationMessage &message)
+{
+	if (message.id != 0)
+		return static_cast<uint32_t>(message.id);
+	return std::hash<std::string>()(message.text) | (uint64_t(1) << 63);
+}
+
+// prints the first of every message id and counts the rest, performance warnings are only counted for the report.
+// false when the queue was empty
+bool drainMessages()
+{
+	validationMessage message;
+	bool any = false;
+	while (pipeline.queue.pop(message)) {
+		any = true;
+		auto inserted = pipeline.seen.emplace(messageKey(message), seenMessage{0, false, {}, {}});
+		seenMessage &entry = inserted.first->second;
+		++entry.count;
+		if (!inserted.second) {
+			++pipeline.folded;
+			continue;
+		}
+		entry.performance = (message.type & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT) != 0;
+		entry.idName = message.idName;
+		if (entry.performance) {
+			entry.text = message.text;
+			continue;
+		}
+		++pipeline.printed;
+		std::cerr << "validation layer (" << severityName(message.severity) << "): " << message.text << std::endl;
+	}
+	return any;
+}
+
+void printMessages()
+{
+	while (pipeline.running.load(std::memory_order_acquire)) {
+		if (!drainMessages())
+			std::this_thread::sleep_for(MESSAGE_POLL_INTERVAL);
+	}
+	drainMessages();
+}
+
+} // namespace
+
 void debugshit::populateDebugMessengerStruct(VkDebugUtilsMessengerCreateInfoEXT &createInfo)
 {
 	createInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_MESSENGER_CREATE_INFO_EXT;
 	createInfo.messageSeverity =
-	    VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
+	    VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT |
+	    VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT;
 	createInfo.messageType =
 	    VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT | VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
 	createInfo.pfnUserCallback = debugshit::debugCallBack;
@@ -16,18 +132,64 @@ void debugshit::populateDebugMessengerStruct(VkDebugUtilsMessengerCreateInfoEXT
 VKAPI_ATTR VkBool32 VKAPI_CALL debugshit::debugCallBack(VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity, VkDebugUtilsMessageTypeFlagsEXT messageType,
 							const VkDebugUtilsMessengerCallbackDataEXT *callbackData, void *userData)
 {
-
-	std::cerr << "validation layer: " << callbackData->pMessage << std::endl;
+	// everything is asked for from the layer so the filter can change at any time, whats not wanted stops here
+	if (messageSeverity < pipeline.minimumSeverity.load(std::memory_order_relaxed) || (messageType & pipeline.types.load(std::memory_order_relaxed)) == 0) {
+		pipeline.filtered.fetch_add(1, std::memory_order_relaxed);
+		return VK_FALSE;
+	}
+	validationMessage message{messageSeverity, messageType, callbackData->messageIdNumber,
+				  callbackData->pMessageIdName ? callbackData->pMessageIdName : "", callbackData->pMessage ? callbackData->pMessage : ""};
+	if (!pipeline.queue.push(std::move(message)))
+		pipeline.dropped.fetch_add(1, std::memory_order_relaxed);
 	return VK_FALSE;
 }
 
+void debugshit::setMessageFilter(VkDebugUtilsMessageSeverityFlagBitsEXT minimumSeverity, VkDebugUtilsMessageTypeFlagsEXT types)
+{
+	pipeline.minimumSeverity.store(minimumSeverity, std::memory_order_relaxed);
+	pipeline.types.store(types, std::memory_order_relaxed);
+}
+
+void debugshit::startMessageThread()
+{
+	if (pipeline.running.exchange(true))
+		return;
+	pipeline.thread = std::thread(printMessages);
+}
+
+void debugshit::stopMessageThread(std::ostream &report)
+{
+	if (!pipeline.running.exchange(false))
+		return;
+	pipeline.thread.join();
+
+	uint64_t performanceCount = 0;
+	for (const auto &entry : pipeline.seen) {
+		if (entry.second.performance)
+			performanceCount += entry.second.count;
+	}
+	report << "validation: " << pipeline.printed << " printed, " << pipeline.folded << " repeats folded, " << performanceCount
+	       << " performance warnings, " << pipeline.filtered.load() << " filtered, " << pipeline.dropped.load() << " dropped (queue full)" << std::endl;
+	for (const auto &entry : pipeline.seen) {
+		if (!entry.second.performance && entry.second.count > 1)
+			report << "  " << entry.second.count << "x " << entry.second.idName << std::endl;
+	}
+	if (performanceCount == 0)
+		return;
+	report << "performance warnings:" << std::endl;
+	for (const auto &entry : pipeline.seen) {
+		if (entry.second.performance)
+			report << "  " << entry.second.count << "x " << entry.second.idName << ": " << entry.second.text << std::endl;
+	}
+}
+
 VkResult debugshit::CreateDebugUtilsMessengerEXT(VkInstance instance, const VkAllocationCallbacks *allocator, VkDebugUtilsMessengerEXT *debugMessenger)
 {
 	VkDebugUtilsMessengerCreateInfoEXT createInfo{};
 	populateDebugMessengerStruct(createInfo);
 	auto lookedUpFunc = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(instance, "vkCreateDebugUtilsMessengerEXT");
 	if (lookedUpFunc != nullptr)
-		return lookedUpFunc(instance, &createInfo, allocator, debugMessenger);
+		return tprofile::timed("vkCreateDebugUtilsMessengerEXT", lookedUpFunc, instance, &createInfo, allocator, debugMessenger);
 	else
 		return VK_ERROR_EXTENSION_NOT_PRESENT;
 }
@@ -38,3 +200,42 @@ void debugshit::destroyDebugUtilsMesssengerExt(VkInstance instance, VkDebugUtils
 	if (func != nullptr)
 		func(instance, debugMessenger, allocator);
 }
+
+static PFN_vkSetDebugUtilsObjectNameEXT setDebugUtilsObjectName = nullptr;
+static PFN_vkCmdBeginDebugUtilsLabelEXT cmdBeginDebugUtilsLabel = nullptr;
+static PFN_vkCmdEndDebugUtilsLabelEXT cmdEndDebugUtilsLabel = nullptr;
+
+void debugshit::loadDebugUtils(VkInstance instance)
+{
+	setDebugUtilsObjectName = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetInstanceProcAddr(instance, "vkSetDebugUtilsObjectNameEXT");
+	cmdBeginDebugUtilsLabel = (PFN_vkCmdBeginDebugUtilsLabelEXT)vkGetInstanceProcAddr(instance, "vkCmdBeginDebugUtilsLabelEXT");
+	cmdEndDebugUtilsLabel = (PFN_vkCmdEndDebugUtilsLabelEXT)vkGetInstanceProcAddr(instance, "vkCmdEndDebugUtilsLabelEXT");
+}
+
+void debugshit::setObjectName(VkDevice device, VkObjectType type, uint64_t handle, const char *name)
+{
+	if (setDebugUtilsObjectName == nullptr || handle == 0)
+		return;
+	VkDebugUtilsObjectNameInfoEXT nameInfo{};
+	nameInfo.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_OBJECT_NAME_INFO_EXT;
+	nameInfo.objectType = type;
+	nameInfo.objectHandle = handle;
+	nameInfo.pObjectName = name;
+	setDebugUtilsObjectName(device, &nameInfo);
+}
+
+void debugshit::beginLabel(VkCommandBuffer commandBuffer, const char *name)
+{
+	if (cmdBeginDebugUtilsLabel == nullptr)
+		return;
+	VkDebugUtilsLabelEXT label{};
+	label.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+	label.pLabelName = name;
+	cmdBeginDebugUtilsLabel(commandBuffer, &label);
+}
+
+void debugshit::endLabel(VkCommandBuffer commandBuffer)
+{
+	if (cmdEndDebugUtilsLabel != nullptr)
+		cmdEndDebugUtilsLabel(commandBuffer);
+}
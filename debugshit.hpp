@@ -6,6 +6,9 @@
 //below define and include tells the included header to also include vulkan deps
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#include <cstdint>
+#include <ostream>
+#include <string>
 
 
 namespace debugshit {
@@ -23,6 +26,57 @@ VkResult CreateDebugUtilsMessengerEXT(VkInstance instance,
 void destroyDebugUtilsMesssengerExt(VkInstance instance, VkDebugUtilsMessengerEXT debugMessenger, const VkAllocationCallbacks* allocator);
 void populateDebugMessengerStruct(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
 
+// validation messages arent printed on the thread that triggered them. the callback filters them, copies them into a
+// lock free queue and returns, a background thread prints the first of every message id and only counts repeats.
+// performance warnings are never printed as they come, they end up in the report instead
+// any thread, any time. the default is warnings and errors of every type
+void setMessageFilter(VkDebugUtilsMessageSeverityFlagBitsEXT minimumSeverity, VkDebugUtilsMessageTypeFlagsEXT types);
+void startMessageThread();
+// prints whatever is still queued, then the repeat counts and every performance warning to report
+void stopMessageThread(std::ostream &report);
+
+// object names and command buffer labels, for reading captures in renderdoc and gpu profilers. the functions are
+// looked up once the instance exists and stay null without the debug utils extension, naming and labels do nothing then.
+// building without TRIANGLE_DEBUG_NAMES_ENABLED turns DEBUG_NAME and DEBUG_LABEL into nothing, arguments included
+void loadDebugUtils(VkInstance instance);
+void setObjectName(VkDevice device, VkObjectType type, uint64_t handle, const char *name);
+void beginLabel(VkCommandBuffer commandBuffer, const char *name);
+void endLabel(VkCommandBuffer commandBuffer);
+
+// takes the handle already cast to uint64_t, non dispatchable handles are all plain uint64_t on 32 bit so the type
+// cant be told from the handle and has to be passed along
+inline void nameObject(VkDevice device, VkObjectType type, uint64_t handle, const std::string &name)
+{
+	setObjectName(device, type, handle, name.c_str());
+}
+
+// a label region over everything recorded while it lives
+class Label {
+      public:
+	Label(VkCommandBuffer commandBuffer, const std::string &name) : commandBuffer(commandBuffer) { beginLabel(commandBuffer, name.c_str()); }
+	~Label() { endLabel(commandBuffer); }
+	Label(const Label &) = delete;
+	Label &operator=(const Label &) = delete;
+
+      private:
+	VkCommandBuffer commandBuffer;
+};
+
 }
 
+#define DEBUG_CONCAT_INNER(a, b) a##b
+#define DEBUG_CONCAT(a, b) DEBUG_CONCAT_INNER(a, b)
+
+#ifdef TRIANGLE_DEBUG_NAMES_ENABLED
+#define DEBUG_NAME(device, type, object, name) debugshit::nameObject(device, type, (uint64_t)(object), name)
+#define DEBUG_LABEL(commandBuffer, name) debugshit::Label DEBUG_CONCAT(debugLabel, __LINE__)(commandBuffer, name)
+#else
+#define DEBUG_NAME(device, type, object, name)                                                                                                       \
+	do {                                                                                                                                         \
+	} while (0)
+#define DEBUG_LABEL(commandBuffer, name)                                                                                                             \
+	do {                                                                                                                                         \
+	} while (0)
+#endif
+
 #endif
\ No newline at end of file
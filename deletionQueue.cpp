@@ -0,0 +1,21 @@
+#include "deletionQueue.hpp"
+#include <stdexcept>
+#include <utility>
+
+void tdeletion::DeletionQueue::push(uint64_t value, std::function<void()> destroy)
+{
+	if (!entries.empty() && value < entries.back().value) {
+		throw std::invalid_argument("deletion queue values have to go up");
+	}
+	entries.push_back({value, std::move(destroy)});
+}
+
+void tdeletion::DeletionQueue::flush(uint64_t completed)
+{
+	while (!entries.empty() && entries.front().value <= completed) {
+		// popped before running so a destroy that throws doesnt run again on the next flush
+		std::function<void()> destroy = std::move(entries.front().destroy);
+		entries.pop_front();
+		destroy();
+	}
+}
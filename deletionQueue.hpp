@@ -0,0 +1,35 @@
+#ifndef TRIANGLE_DELETION_QUEUE_HEADER
+#define TRIANGLE_DELETION_QUEUE_HEADER
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+// destruction that has to wait for the gpu. every entry is tagged with a value from a counter that only goes up (a frame
+// number, a timeline semaphore value) and runs once the owner of that counter says the gpu got past it, so replacing
+// something at runtime never needs a device or queue wait
+namespace tdeletion {
+
+class DeletionQueue {
+      public:
+	// value has to be at least the one pushed before it, the queue is kept in order that way. with frame numbers it is
+	// the frames submitted so far including the current one: something the current frame was already submitted with
+	// has to count that frame too, or it gets destroyed one frame early
+	void push(uint64_t value, std::function<void()> destroy);
+	// runs everything tagged with a value up to completed, oldest first
+	void flush(uint64_t completed);
+	// for when the device is idle
+	void flushAll() { flush(UINT64_MAX); }
+	size_t size() const { return entries.size(); }
+
+      private:
+	struct entry {
+		uint64_t value;
+		std::function<void()> destroy;
+	};
+	std::deque<entry> entries;
+};
+
+} // namespace tdeletion
+
+#endif
@@ -0,0 +1,138 @@
+#include "gpuTimers.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+void tgputime::GpuTimers::create(VkDevice device, uint32_t slotCount, uint32_t scopesPerSlot, float timestampPeriod, uint32_t validBits)
+{
+	if (validBits == 0)
+		return;
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = slotCount * scopesPerSlot * 2;
+	if (tprofile::timed("vkCreateQueryPool", vkCreateQueryPool, device, &queryPoolInfo, nullptr, &pool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create timestamp query pool");
+	}
+	this->scopesPerSlot = scopesPerSlot;
+	nanosecondsPerTick = timestampPeriod;
+	// only the low validBits of a timestamp count, the difference has to wrap the same way
+	tickMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+	slots.assign(slotCount, slot{});
+}
+
+void tgputime::GpuTimers::destroy(VkDevice device)
+{
+	if (pool == VK_NULL_HANDLE)
+		return;
+	vkDestroyQueryPool(device, pool, nullptr);
+	pool = VK_NULL_HANDLE;
+	slots.clear();
+}
+
+void tgputime::GpuTimers::beginSlot(VkCommandBuffer commandBuffer, uint32_t slot)
+{
+	if (pool == VK_NULL_HANDLE)
+		return;
+	vkCmdResetQueryPool(commandBuffer, pool, slot * scopesPerSlot * 2, scopesPerSlot * 2);
+	slots[slot].state = slotState::recording;
+	slots[slot].scopes.clear();
+}
+
+uint32_t tgputime::GpuTimers::begin(VkCommandBuffer commandBuffer, uint32_t slot, const std::string &name)
+{
+	if (pool == VK_NULL_HANDLE || slots[slot].scopes.size() >= scopesPerSlot)
+		return UINT32_MAX;
+	uint32_t nameIndex = static_cast<uint32_t>(std::find(names.begin(), names.end(), name) - names.begin());
+	if (nameIndex == names.size()) {
+		names.push_back(name);
+		history.emplace_back();
+	}
+	uint32_t scope = static_cast<uint32_t>(slots[slot].scopes.size());
+	slots[slot].scopes.push_back(nameIndex);
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, pool, (slot * scopesPerSlot + scope) * 2);
+	return scope;
+}
+
+void tgputime::GpuTimers::end(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t scope)
+{
+	if (pool == VK_NULL_HANDLE || scope == UINT32_MAX)
+		return;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, pool, (slot * scopesPerSlot + scope) * 2 + 1);
+}
+
+void tgputime::GpuTimers::submitted(uint32_t slot)
+{
+	if (pool != VK_NULL_HANDLE)
+		slots[slot].state = slotState::submitted;
+}
+
+void tgputime::GpuTimers::collect(VkDevice device, uint32_t slot)
+{
+	if (pool == VK_NULL_HANDLE || slots[slot].state != slotState::submitted)
+		return;
+	const std::vector<uint32_t> &scopes = slots[slot].scopes;
+	slots[slot].state = slotState::idle;
+	if (scopes.empty())
+		return;
+	// value and availability for every query, begin and end of each scope next to each other
+	std::vector<uint64_t> results(scopes.size() * 4);
+	VkResult result = vkGetQueryPoolResults(device, pool, slot * scopesPerSlot * 2, static_cast<uint32_t>(scopes.size() * 2),
+						results.size() * sizeof(uint64_t), results.data(), 2 * sizeof(uint64_t),
+						VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+		return;
+	for (size_t scope = 0; scope < scopes.size(); ++scope) {
+		const uint64_t *pair = &results[scope * 4];
+		if (pair[1] == 0 || pair[3] == 0)
+			continue;
+		double ms = static_cast<double>((pair[2] - pair[0]) & tickMask) * nanosecondsPerTick / 1e6;
+		rolling &r = history[scopes[scope]];
+		if (r.samples.size() < ROLLING_WINDOW) {
+			r.samples.push_back(ms);
+		} else {
+			r.samples[r.next] = ms;
+			r.next = (r.next + 1) % ROLLING_WINDOW;
+		}
+	}
+}
+
+uint32_t tgputime::GpuTimers::idleSlot() const
+{
+	for (uint32_t i = 0; i < slots.size(); ++i) {
+		if (slots[i].state == slotState::idle)
+			return i;
+	}
+	return UINT32_MAX;
+}
+
+std::map<std::string, tgputime::scopeStats> tgputime::GpuTimers::stats() const
+{
+	std::map<std::string, scopeStats> all;
+	for (size_t i = 0; i < names.size(); ++i) {
+		const std::vector<double> &samples = history[i].samples;
+		if (samples.empty())
+			continue;
+		scopeStats s{samples[0], 0.0, samples[0], static_cast<uint32_t>(samples.size())};
+		for (double ms : samples) {
+			s.minMs = std::min(s.minMs, ms);
+			s.maxMs = std::max(s.maxMs, ms);
+			s.averageMs += ms;
+		}
+		s.averageMs /= samples.size();
+		all[names[i]] = s;
+	}
+	return all;
+}
+
+void tgputime::GpuTimers::report(std::ostream &out) const
+{
+	out << std::fixed << std::setprecision(3);
+	for (auto &entry : stats()) {
+		const scopeStats &s = entry.second;
+		out << "  " << entry.first << ": " << s.minMs << " / " << s.averageMs << " / " << s.maxMs << " ms min / avg / max over " << s.samples
+		    << std::endl;
+	}
+	out << std::defaultfloat << std::setprecision(6);
+}
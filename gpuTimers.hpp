@@ -0,0 +1,71 @@
+#ifndef TRIANGLE_GPU_TIMERS_HEADER
+#define TRIANGLE_GPU_TIMERS_HEADER
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+// named gpu time spans from timestamp queries. the pool is split into slots, one per command buffer that can be in
+// flight at once (a frame slot, an upload), and a slot is only read back once whoever owns it knows the gpu is past it,
+// so reading never waits. every name keeps a rolling window of its latest times
+namespace tgputime {
+
+// how many of the latest samples min, average and max are over
+const uint32_t ROLLING_WINDOW = 256;
+
+struct scopeStats {
+	double minMs;
+	double averageMs;
+	double maxMs;
+	uint32_t samples; // in the window, at most ROLLING_WINDOW
+};
+
+class GpuTimers {
+      public:
+	// does nothing when validBits is 0, the queue family cant write timestamps then and every call below is a no-op
+	void create(VkDevice device, uint32_t slotCount, uint32_t scopesPerSlot, float timestampPeriod, uint32_t validBits);
+	void destroy(VkDevice device);
+	bool enabled() const { return pool != VK_NULL_HANDLE; }
+
+	// resets the slots queries, has to be recorded before any scope of the slot and outside a render pass
+	void beginSlot(VkCommandBuffer commandBuffer, uint32_t slot);
+	// returns what to pass to end, scopes past scopesPerSlot dont get timed
+	uint32_t begin(VkCommandBuffer commandBuffer, uint32_t slot, const std::string &name);
+	void end(VkCommandBuffer commandBuffer, uint32_t slot, uint32_t scope);
+	// the commands of the slot were submitted, a command buffer recorded once and submitted again counts every time
+	void submitted(uint32_t slot);
+	// adds the times of the slots last submission to the rolling stats. only once the gpu is done with it, a scope that
+	// still isnt available is dropped instead of waited for
+	void collect(VkDevice device, uint32_t slot);
+	// a slot with nothing submitted and not collected, UINT32_MAX if all are busy
+	uint32_t idleSlot() const;
+
+	std::map<std::string, scopeStats> stats() const;
+	void report(std::ostream &out) const;
+
+      private:
+	enum class slotState { idle, recording, submitted };
+	struct slot {
+		slotState state = slotState::idle;
+		std::vector<uint32_t> scopes; // index into names of every scope recorded into the slot
+	};
+	struct rolling {
+		std::vector<double> samples;
+		uint32_t next = 0;
+	};
+
+	VkQueryPool pool = VK_NULL_HANDLE;
+	uint32_t scopesPerSlot = 0;
+	double nanosecondsPerTick = 1.0;
+	uint64_t tickMask = 0;
+	std::vector<slot> slots;
+	std::vector<std::string> names;
+	std::vector<rolling> history; // parallel to names
+};
+
+} // namespace tgputime
+
+#endif
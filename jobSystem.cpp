@@ -0,0 +1,245 @@
+#include "jobSystem.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+// which system and worker the current thread belongs to, threads outside every pool are worker 0 of all of them
+static thread_local const tjobs::JobSystem *currentSystem = nullptr;
+static thread_local uint32_t currentIndex = 0;
+
+tjobs::JobSystem::JobSystem(uint32_t workerCount)
+{
+	if (workerCount == 0)
+		workerCount = std::max(1u, std::thread::hardware_concurrency());
+	for (uint32_t i = 0; i < workerCount; ++i) {
+		workers.push_back(std::make_unique<worker>());
+	}
+	for (uint32_t i = 1; i < workerCount; ++i) {
+		threads.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+}
+
+tjobs::JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto &thread : threads) {
+		thread.join();
+	}
+}
+
+uint32_t tjobs::JobSystem::currentWorker() const { return currentSystem == this ? currentIndex : 0; }
+
+void tjobs::JobSystem::run(Counter &counter, std::function<void()> work)
+{
+	counter.pending.fetch_add(1, std::memory_order_relaxed);
+	// counted before its visible so takeJob never sees more jobs than the count says
+	queuedJobs.fetch_add(1, std::memory_order_release);
+	worker &own = *workers[currentWorker()];
+	{
+		std::lock_guard<std::mutex> lock(own.mutex);
+		own.jobs.push_back({std::move(work), &counter});
+	}
+	// taking the lock orders this against a worker that just saw queuedJobs == 0 and is about to sleep
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wake.notify_one();
+}
+
+bool tjobs::JobSystem::takeJob(uint32_t self, job &taken)
+{
+	if (queuedJobs.load(std::memory_order_acquire) == 0)
+		return false;
+	{
+		worker &own = *workers[self];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (!own.jobs.empty()) {
+			taken = std::move(own.jobs.back());
+			own.jobs.pop_back();
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	uint32_t count = size();
+	for (uint32_t offset = 1; offset < count; ++offset) {
+		worker &victim = *workers[(self + offset) % count];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty()) {
+			taken = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void tjobs::JobSystem::execute(uint32_t self, job &taken)
+{
+	TRACE_ZONE("job");
+	auto start = std::chrono::steady_clock::now();
+	try {
+		taken.work();
+	} catch (...) {
+		std::lock_guard<std::mutex> lock(taken.counter->errorMutex);
+		if (!taken.counter->error)
+			taken.counter->error = std::current_exception();
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+	worker &own = *workers[self];
+	own.busyNanoseconds.fetch_add(static_cast<uint64_t>(elapsed), std::memory_order_relaxed);
+	own.executed.fetch_add(1, std::memory_order_relaxed);
+	// the job is destroyed before the counter drops, whatever it captured may not outlive the wait
+	Counter *counter = taken.counter;
+	taken.work = nullptr;
+	counter->pending.fetch_sub(1, std::memory_order_acq_rel);
+}
+
+void tjobs::JobSystem::wait(Counter &counter)
+{
+	uint32_t self = currentWorker();
+	job taken;
+	while (!counter.done()) {
+		if (takeJob(self, taken)) {
+			execute(self, taken);
+		} else {
+			// whats left of the group is running on other workers
+			std::this_thread::yield();
+		}
+	}
+	std::lock_guard<std::mutex> lock(counter.errorMutex);
+	if (counter.error) {
+		std::exception_ptr thrown = counter.error;
+		counter.error = nullptr;
+		std::rethrow_exception(thrown);
+	}
+}
+
+void tjobs::JobSystem::parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)> &body)
+{
+	if (count == 0)
+		return;
+	grain = std::max(grain, 1u);
+	// a single chunk isnt worth a trip through the deques
+	if (count <= grain) {
+		body(0, count);
+		return;
+	}
+	Counter counter;
+	for (uint32_t begin = 0; begin < count; begin += grain) {
+		uint32_t end = std::min(count, begin + grain);
+		run(counter, [&body, begin, end] { body(begin, end); });
+	}
+	wait(counter);
+}
+
+tjobs::JobSystem::workerStats tjobs::JobSystem::stats(uint32_t index) const
+{
+	const worker &w = *workers.at(index);
+	return {w.executed.load(std::memory_order_relaxed), w.busyNanoseconds.load(std::memory_order_relaxed) * 1e-9};
+}
+
+void tjobs::JobSystem::resetStats()
+{
+	for (auto &w : workers) {
+		w->executed = 0;
+		w->busyNanoseconds = 0;
+	}
+}
+
+void tjobs::JobSystem::workerLoop(uint32_t self)
+{
+	currentSystem = this;
+	currentIndex = self;
+	if (ttrace::enabled())
+		ttrace::nameThread("job worker " + std::to_string(self));
+	job taken;
+	for (;;) {
+		if (takeJob(self, taken)) {
+			execute(self, taken);
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [this] { return stopping || queuedJobs.load(std::memory_order_acquire) > 0; });
+		if (stopping)
+			return;
+	}
+}
+
+// a few hundred ns of integer work that the compiler cant fold away
+static uint32_t spin(uint32_t seed, uint32_t rounds)
+{
+	for (uint32_t i = 0; i < rounds; ++i) {
+		seed = seed * 1664525u + 1013904223u;
+		seed ^= seed >> 13;
+	}
+	return seed;
+}
+
+template <typename Function> static double timeSeconds(Function &&function)
+{
+	auto start = std::chrono::steady_clock::now();
+	function();
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static double averageUtilization(const tjobs::JobSystem &jobs, double seconds)
+{
+	double busy = 0.0;
+	for (uint32_t i = 0; i < jobs.size(); ++i) {
+		busy += jobs.stats(i).busySeconds;
+	}
+	return busy / (seconds * jobs.size());
+}
+
+void tjobs::runBenchmarks()
+{
+	const uint32_t emptyJobs = 1 << 20;
+	const uint32_t forItems = 1 << 16;
+	const uint32_t roundsPerItem = 256;
+	uint32_t maxWorkers = std::max(1u, std::thread::hardware_concurrency());
+
+	std::cout << "job system, " << emptyJobs << " empty jobs and a " << forItems << " item parallel for (" << roundsPerItem
+		  << " rounds of work per item, grain 64)" << std::endl;
+	double baseline = 0.0;
+	for (uint32_t workerCount = 1;; workerCount = std::min(workerCount * 2, maxWorkers)) {
+		JobSystem jobs(workerCount);
+
+		// all pushed from outside the pool, the workers only get them by stealing from worker 0
+		double emptySeconds = timeSeconds([&] {
+			Counter counter;
+			for (uint32_t i = 0; i < emptyJobs; ++i) {
+				jobs.run(counter, [] {});
+			}
+			jobs.wait(counter);
+		});
+
+		std::vector<uint32_t> results(forItems);
+		jobs.resetStats();
+		double forSeconds = timeSeconds([&] {
+			jobs.parallelFor(forItems, 64, [&](uint32_t begin, uint32_t end) {
+				for (uint32_t i = begin; i < end; ++i) {
+					results[i] = spin(i, roundsPerItem);
+				}
+			});
+		});
+		if (workerCount == 1)
+			baseline = forSeconds;
+		// cheap check that every item got run exactly by one chunk
+		for (uint32_t i = 0; i < forItems; i += 4099) {
+			if (results[i] != spin(i, roundsPerItem))
+				throw std::runtime_error("parallel for skipped an item");
+		}
+
+		std::cout << workerCount << " workers: " << emptyJobs / emptySeconds / 1e6 << " M jobs/s, parallel for " << forSeconds * 1e3 << " ms, "
+			  << baseline / forSeconds << "x speedup, " << averageUtilization(jobs, forSeconds) * 100.0 << "% utilization" << std::endl;
+		if (workerCount == maxWorkers)
+			break;
+	}
+}
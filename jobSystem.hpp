@@ -0,0 +1,91 @@
+#ifndef TRIANGLE_JOB_SYSTEM_HEADER
+#define TRIANGLE_JOB_SYSTEM_HEADER
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// work stealing job scheduler. every worker has its own deque, it pushes and pops at the back (newest first, still
+// in cache) and when that runs dry it steals from the front of someone elses (oldest first, usually the biggest chunk
+// of work left). threads that arent workers (main, render) count as worker 0 and share its deque, they only run
+// jobs while waiting on a counter
+namespace tjobs {
+
+// how many jobs of a group are still queued or running. a job is added to one with run and the group is waited on
+// with wait, that is also how jobs depend on each other: wait on the counter of whatever has to be done first
+class Counter {
+      public:
+	bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+
+      private:
+	friend class JobSystem;
+	std::atomic<uint32_t> pending{0};
+	std::mutex errorMutex;
+	std::exception_ptr error; // first exception thrown by a job of this group
+};
+
+class JobSystem {
+      public:
+	// workerCount 0 = one per hardware thread, the calling thread is one of them so workerCount - 1 threads are started
+	explicit JobSystem(uint32_t workerCount = 0);
+	~JobSystem();
+	JobSystem(const JobSystem &) = delete;
+	JobSystem &operator=(const JobSystem &) = delete;
+
+	uint32_t size() const { return static_cast<uint32_t>(workers.size()); }
+	// queues job on the calling workers deque. counter has to outlive the job
+	void run(Counter &counter, std::function<void()> job);
+	// runs queued jobs (any, not just this groups) until counter is done, then rethrows the first exception of the group
+	void wait(Counter &counter);
+	// calls body(begin, end) on chunks of at most grain items covering [0, count) spread over the workers, returns once
+	// all of them are done
+	void parallelFor(uint32_t count, uint32_t grain, const std::function<void(uint32_t, uint32_t)> &body);
+
+	// worker the calling thread runs as, 0 for threads outside the pool
+	uint32_t currentWorker() const;
+
+	// utilization since the last resetStats, busy is time spent inside jobs
+	struct workerStats {
+		uint64_t jobs;
+		double busySeconds;
+	};
+	workerStats stats(uint32_t worker) const;
+	void resetStats();
+
+      private:
+	struct job {
+		std::function<void()> work;
+		Counter *counter;
+	};
+	struct alignas(64) worker {
+		std::mutex mutex;
+		std::deque<job> jobs;
+		std::atomic<uint64_t> executed{0};
+		std::atomic<uint64_t> busyNanoseconds{0};
+	};
+
+	bool takeJob(uint32_t self, job &taken);
+	void execute(uint32_t self, job &taken);
+	void workerLoop(uint32_t self);
+
+	std::vector<std::unique_ptr<worker>> workers;
+	std::vector<std::thread> threads;
+	std::atomic<uint32_t> queuedJobs{0}; // across all deques, idle workers sleep while its 0
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	bool stopping = false;
+};
+
+// empty job throughput and parallel for scaling for 1 up to every hardware thread, prints the results
+void runBenchmarks();
+
+} // namespace tjobs
+
+#endif
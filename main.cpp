@@ -10,18 +10,38 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
+#include "apiCounters.hpp"
+#include "assetRegistry.hpp"
 #include "debugshit.hpp"
+#include "deletionQueue.hpp"
+#include "gpuTimers.hpp"
+#include "jobSystem.hpp"
 #include "p_device.hpp"
+#include "pipelineStats.hpp"
+#include "pixelConversion.hpp"
 #include "presentation.hpp"
+#include "profiler.hpp"
+#include "renderGraph.hpp"
 #include "requirement.hpp"
+#include "samplerCache.hpp"
+#include "settings.hpp"
 #include "shaderLoading.hpp"
+#include "spscQueue.hpp"
+#include "stallAnalyzer.hpp"
+#include "taskGraph.hpp"
+#include "timeline.hpp"
+#include "trace.hpp"
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdlib>
 #include <glm/glm.hpp>
 #include <iostream>
+#include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string.h>
+#include <thread>
 #include <vector>
 #define GLM_FORCE_RADIANS
 // glm uses depth range -1 to 1, we want 0 to 1 to coincide with vulkan expectation
@@ -36,11 +56,30 @@
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
-const int MAX_FRAMES_IN_FLIGHT = 2;
 const int WINDOW_HEIGHT = 800;
 const int WINDOW_WIDTH = 600;
 const std::string MODEL_PATH = "models/viking_room.obj";
 const std::string TEXTURE_PATH = "textures/viking_room.png";
+// has to match the size of dstMips in shaders/mipgen.comp
+const uint32_t MIPGEN_MAX_MIPS_PER_DISPATCH = 12;
+// size of the bindless texture array, lowered to the device limit if thats smaller
+const uint32_t MAX_BINDLESS_TEXTURES = 4096;
+// timed scopes a frame command buffer can hold, the whole frame plus one per render graph pass
+const uint32_t FRAME_TIMER_SCOPES = 16;
+// uploads that can be timed at once, one past this is just not timed
+const uint32_t UPLOAD_TIMER_SLOTS = 16;
+// frames after startup or a swapchain recreation that --api-counters leaves out, command caching and uploads settle in them
+const uint32_t API_COUNTER_WARMUP_FRAMES = 8;
+// --draws, --report-latency, --report-gpu-time and --api-counters print their numbers every this many frames
+const uint32_t STATS_REPORT_INTERVAL = 1000;
+// draws per job when the per draw transforms are computed in parallel, below this it all runs on the calling thread
+const uint32_t TRANSFORM_JOB_GRAIN = 1024;
+// pixels per job when expanding rgb textures into staging memory
+const uint32_t PIXEL_JOB_GRAIN = 64 * 1024;
+// how often the event thread wakes up without any events, each wakeup counts as an input sample
+const double EVENT_POLL_INTERVAL = 0.001;
+// events the render thread can fall behind by before new input samples get dropped
+const size_t EVENT_QUEUE_CAPACITY = 256;
 
 struct Vertex {
 	glm::vec3 pos;
@@ -89,22 +128,104 @@ template <> struct hash<Vertex> {
 };
 } // namespace std
 
-struct UniformBufferObject {
+struct MipGenPushConstants {
+	int32_t srcSize[2];
+	int32_t mipCount;
+	int32_t workGroupCount;
+};
+
+// stuff that has to stay alive until the mip generation command buffer is done
+struct MipGenScratch {
+	VkDescriptorPool descriptorPool = VK_NULL_HANDLE;
+	std::vector<VkImageView> levelViews;
+};
+
+// gpu side of a loaded texture, shared through the asset registry by everything using the same image contents
+struct TextureAsset {
+	VkImage image;
+	VkDeviceMemory memory;
+	VkImageView view;
+	uint32_t mipLevels;
+};
+
+// same for meshes
+struct MeshAsset {
+	VkBuffer vertexBuffer;
+	VkDeviceMemory vertexBufferMemory;
+	VkBuffer indexBuffer;
+	VkDeviceMemory indexBufferMemory;
+	uint32_t indexCount;
+};
+
+// what loadTexture and loadModel have before touching the device, so reading and decoding the files can run on any
+// thread and before vulkan is even up
+struct DecodedTexture {
+	tasset::assetKey key;
+	int width;
+	int height;
+	bool hasAlpha; // rgba if set, rgb otherwise
+	stbi_uc *pixels; // freed by uploadTexture
+};
+
+struct DecodedMesh {
+	tasset::assetKey key;
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices;
+};
+
+// per draw data, has to match the DrawConstants blocks in shaders/shader.vert and shaders/bindless.frag.
+// model goes to the vertex shader and textureIndex to the fragment shader so they are separate push constant ranges
+struct DrawPushConstants {
+	glm::mat4 model;
+	uint32_t textureIndex;
+};
+
+// shared by every draw in a frame
+struct CameraUniforms {
 	// be explicit abt alignments, it needs to match the vulkan spec once it goes to the shader
-	alignas(16) glm::mat4 model;
 	alignas(16) glm::mat4 view;
 	alignas(16) glm::mat4 proj;
 };
 
+// one per draw in the dynamic offset ring, only used with --transforms=dynamic
+struct ObjectUniforms {
+	alignas(16) glm::mat4 model;
+};
+
 class TriangleApp
 {
       public:
 	void run(void)
 	{
+		bool profileStartup = !tsettings::settings.startupProfilePath.empty();
+		if (profileStartup)
+			tprofile::start();
+		if (!tsettings::settings.tracePath.empty()) {
+			ttrace::enable();
+			ttrace::nameThread("main");
+		}
+		// up before the instance, creating it can already produce messages
+		if (enableValidationLayers) {
+			applyValidationFilter();
+			debugshit::startMessageThread();
+		}
 		initWindow();
 		initVulkan();
+		tprofile::stop();
 		mainLoop();
 		cleanup();
+		if (enableValidationLayers)
+			debugshit::stopMessageThread(std::cout);
+		if (profileStartup) {
+			tprofile::report(std::cout);
+			tprofile::writeJson(tsettings::settings.startupProfilePath);
+		}
+		if (ttrace::enabled())
+			ttrace::write(tsettings::settings.tracePath);
+		if (!tsettings::settings.stallReportPath.empty()) {
+			stalls.printSummary(std::cout);
+			stalls.writeJson(tsettings::settings.stallReportPath);
+		}
 	}
 
       private:
@@ -113,13 +234,20 @@ class TriangleApp
 	VkDevice device; // logical device
 	VkDebugUtilsMessengerEXT debugMessenger;
 	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+	p_device::DeviceCapabilities deviceCapabilities;
 	VkSurfaceKHR surface;
 	VkQueue graphicsQueue;
 	VkQueue presentQueue;
 	trianglePresentation::swapchainInformation swapchainInfo;
 	std::vector<VkImageView> swapChainImageViews;
-	std::vector<VkFramebuffer> swapChainFramebuffers;
-	VkRenderPass renderPass;
+	std::vector<VkFramebuffer> swapChainFramebuffers; // only with the render pass path
+	VkRenderPass renderPass = VK_NULL_HANDLE;
+	// --rendering: with dynamic rendering the scene pass renders straight into the graphs image views, no render pass
+	// or framebuffers to keep around and nothing to rebuild on resize besides the graph
+	bool useDynamicRendering = false;
+	PFN_vkCmdBeginRenderingKHR cmdBeginRendering = nullptr;
+	PFN_vkCmdEndRenderingKHR cmdEndRendering = nullptr;
+	VkFormat depthFormat = VK_FORMAT_UNDEFINED;
 	VkDescriptorSetLayout descriptorSetLayout;
 	VkDescriptorPool descriptorPool;
 	std::vector<VkDescriptorSet> descriptorSets;
@@ -127,122 +255,395 @@ class TriangleApp
 	VkPipeline graphicsPipeline;
 	VkCommandPool commandPool;
 	VkCommandPool memoryTransferCommandPool;
+	uint32_t framesInFlight = 2; // from --frames-in-flight, fixed once initVulkan starts
 	uint32_t currentFrame = 0;
-	VkBuffer vertexBuffer;
-	VkDeviceMemory vertexBufferMemory;
-	VkBuffer indexBuffer;
-	VkDeviceMemory indexBufferMemory;
 	std::vector<VkBuffer> uniformBuffers;
 	std::vector<VkDeviceMemory> uniformBuffersMemory;
 	std::vector<void *> uniformBuffersMapped;
+	// per frame ring of ObjectUniforms, one slot per draw every objectUniformStride bytes
+	std::vector<VkBuffer> objectUniformBuffers;
+	std::vector<VkDeviceMemory> objectUniformBuffersMemory;
+	std::vector<void *> objectUniformBuffersMapped;
+	VkDeviceSize objectUniformStride = 0;
+	std::vector<glm::mat4> drawTransforms;
+	double drawCostSeconds = 0.0;
+	uint32_t drawCostFrames = 0;
+
+	// latency bookkeeping: when the input a frame was built from got sampled, per frame in flight slot
+	std::chrono::high_resolution_clock::time_point lastInputTime;
+	std::vector<std::chrono::high_resolution_clock::time_point> frameInputTimes;
+	std::vector<bool> frameRetirePending;
+	double presentLatencySum = 0.0, presentLatencyMax = 0.0;
+	double retireLatencySum = 0.0, retireLatencyMax = 0.0;
+	uint32_t presentLatencySamples = 0, retireLatencySamples = 0;
+	// time between presents, jitter is their standard deviation
+	std::chrono::high_resolution_clock::time_point lastPresentTime;
+	double frameTimeSum = 0.0, frameTimeSquaredSum = 0.0;
+	uint32_t frameTimeSamples = 0;
 	std::vector<VkCommandBuffer> commandBuffers;
+	// --cache-commands: prerecorded buffers for every (frame in flight, swapchain image) pair at frame * imageCount + image,
+	// only re-recorded after invalidateCommandCache
+	bool useCommandCache = false;
+	std::vector<VkCommandBuffer> cachedCommandBuffers;
+	std::vector<bool> cachedCommandBufferValid;
+	// shared by everything that splits cpu work up, one worker per core unless --job-threads says otherwise
+	std::unique_ptr<tjobs::JobSystem> jobs;
+	// --record-threads: the draws are split into this many chunks, each recorded as a job into its own pool + secondary
+	// buffer per frame in flight, indexed [frame][chunk]
+	uint32_t recordChunkCount = 0;
+	std::vector<std::vector<VkCommandPool>> recordCommandPools;
+	std::vector<std::vector<VkCommandBuffer>> recordSecondaryBuffers;
 	std::vector<VkSemaphore> imageAvailableSemaphores;
 	std::vector<VkSemaphore> renderFinishedSemaphores;
-	std::vector<VkFence> inFlightFences;
-	uint32_t mipLevels;
-	VkImage textureImage;
-	VkDeviceMemory textureImageMemory;
-	VkImageView textureImageView;
-	VkSampler textureSampler;
-
-	VkImage depthImage;
-	VkDeviceMemory depthImageMemory;
-	VkImageView depthImageView;
-
-	std::vector<Vertex> vertices;
-	std::vector<uint32_t> indices;
+	std::vector<VkFence> inFlightFences; // only without timeline semaphores
+	// --sync: with timelines every frame signals the next graphics value and every upload the next transfer value,
+	// a frame slot is free again once the graphics timeline reaches the value stored for it
+	bool useTimeline = false;
+	ttimeline::Timeline graphicsTimeline;
+	ttimeline::Timeline transferTimeline;
+	std::vector<uint64_t> frameTimelineValues;
+	// deferred destruction. frameDeletions is tagged with the frames submitted so far, frameNumber + 1 once the current
+	// frame went to the queue, and runs once all of them are done. uploadDeletions with transfer timeline values for command and staging buffers of uploads
+	tdeletion::DeletionQueue frameDeletions;
+	tdeletion::DeletionQueue uploadDeletions;
+	// gpu timestamps, a slot per frame in flight and one per upload thats still running
+	tgputime::GpuTimers frameTimers;
+	tgputime::GpuTimers uploadTimers;
+	std::unordered_map<VkCommandBuffer, std::pair<uint32_t, uint32_t>> timedUploads; // slot and scope of an upload being recorded
+	uint32_t passTimerScope = UINT32_MAX;
+	uint32_t gpuTimeFrames = 0;
+	tgputime::PipelineStats pipelineStats;
+	tstall::StallAnalyzer stalls;
+	uint32_t stallFrames = 0;
+	uint32_t apiWarmupFrames = API_COUNTER_WARMUP_FRAMES;
+	bool apiHavePrevious = false;
+	tapi::callCounts apiPreviousFrame;
+	tapi::callCounts apiTotals;
+	uint32_t apiFrames = 0;
+	uint32_t pipelineStatsFrames = 0;
+	std::chrono::high_resolution_clock::time_point pipelineStatsStart;
+	tasset::Registry<TextureAsset> textureAssets;
+	tasset::Registry<MeshAsset> meshAssets;
+	tasset::assetKey textureKey;
+	tasset::assetKey modelKey;
+	const TextureAsset *texture = nullptr;
+	const MeshAsset *model = nullptr;
+	tsampler::SamplerCache samplerCache;
+	VkSampler textureSampler; // owned by samplerCache
+	bool useComputeMipGen = false;
+	VkDescriptorSetLayout mipGenDescriptorSetLayout;
+	VkPipelineLayout mipGenPipelineLayout;
+	VkPipeline mipGenPipeline;
+	VkBuffer mipGenCounterBuffer;
+	VkDeviceMemory mipGenCounterBufferMemory;
+
+	// bindless: one descriptor set for the whole app holding every texture, draws pick theirs with a push constant
+	bool useBindless = false;
+	VkDescriptorSetLayout bindlessSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool bindlessDescriptorPool;
+	VkDescriptorSet bindlessDescriptorSet;
+	uint32_t bindlessTextureCapacity = 0;
+	uint32_t bindlessTextureCount = 0;
+	uint32_t textureIndex = 0; // index of texture->view in the bindless array
 
 	VkSampleCountFlagBits msaaSamples = VK_SAMPLE_COUNT_1_BIT;
-	VkImage colorImage;
-	VkDeviceMemory colorImageMemory;
-	VkImageView colorImageView;
 
-	bool framebufferResized = false;
+	// the frame as a graph, rebuilt with the swapchain. it owns the msaa color and depth targets and does every
+	// barrier and layout transition between them and the swapchain image
+	tgraph::RenderGraph frameGraph;
+	tgraph::resourceHandle swapchainTarget, sceneColor, sceneDepth, meshVertices, meshIndices;
+	uint32_t recordingImageIndex = 0; // swapchain image the graph is being recorded for
+
+	uint64_t frameNumber = 0; // frames submitted so far
+
+	// glfw stays on the main thread (it has to), drawing happens on a render thread. everything the window does reaches
+	// the renderer as a windowEvent through the queue, the two threads share nothing else while running
+	struct windowEvent {
+		enum class type { input, resize, close };
+		type kind;
+		std::chrono::high_resolution_clock::time_point time; // when the event thread saw it
+		VkExtent2D framebufferSize; // resize only
+	};
+	tqueue::SpscQueue<windowEvent, EVENT_QUEUE_CAPACITY> events;
+	bool useRenderThread = false;
+	std::atomic<bool> renderStopped{false}; // set by the render thread on its way out, ends the event loop
+
+	// event thread side, only touched by glfw callbacks and publishEvents
+	bool resizeUnpublished = false;
+	bool closePublished = false;
+	VkExtent2D resizedFramebufferSize{};
+
+	// render thread side, only touched by drainEvents and the renderer
+	VkExtent2D framebufferSize{};
+	bool framebufferResized = false; // a resize message came in since the swapchain was last created
+	bool closeRequested = false;
 
 	void initWindow(void)
 	{
 		glfwInit();
 		glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-		glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+		glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 		window = glfwCreateWindow(WINDOW_HEIGHT, WINDOW_WIDTH, "Vulkanerino", nullptr, nullptr);
 		glfwSetWindowUserPointer(window, this);
 		glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+		glfwSetKeyCallback(window, keyCallback);
+		int width, height;
+		glfwGetFramebufferSize(window, &width, &height);
+		framebufferSize = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
 	}
 	static void framebufferResizeCallback(GLFWwindow *window, int width, int height)
 	{
 		auto app = reinterpret_cast<TriangleApp *>(glfwGetWindowUserPointer(window));
-		app->framebufferResized = true;
+		app->resizedFramebufferSize = {static_cast<uint32_t>(width), static_cast<uint32_t>(height)};
+		app->resizeUnpublished = true;
 	}
+	// F12 writes the trace so far, the rings keep recording while it does
+	static void keyCallback(GLFWwindow *, int key, int, int action, int)
+	{
+		if (key != GLFW_KEY_F12 || action != GLFW_PRESS || !ttrace::enabled())
+			return;
+		try {
+			ttrace::write(tsettings::settings.tracePath);
+			std::cout << "wrote trace to " << tsettings::settings.tracePath << std::endl;
+		} catch (const std::exception &e) {
+			std::cerr << e.what() << std::endl;
+		}
+	}
+
+	// event thread: hands whatever the last poll produced to the renderer. resize and close are kept until they fit,
+	// an input sample that doesnt fit is dropped since the next one is newer anyway
+	void publishEvents(void)
+	{
+		if (tsettings::settings.eventLoadMicros > 0) {
+			auto busyUntil = std::chrono::high_resolution_clock::now() + std::chrono::microseconds(tsettings::settings.eventLoadMicros);
+			while (std::chrono::high_resolution_clock::now() < busyUntil) {
+			}
+		}
+		auto now = std::chrono::high_resolution_clock::now();
+		if (resizeUnpublished && events.push({windowEvent::type::resize, now, resizedFramebufferSize}))
+			resizeUnpublished = false;
+		if (!closePublished && glfwWindowShouldClose(window) && events.push({windowEvent::type::close, now, {}}))
+			closePublished = true;
+		events.push({windowEvent::type::input, now, {}});
+	}
+
+	// render thread: applies everything published so far
+	void drainEvents(void)
+	{
+		windowEvent event;
+		while (events.pop(event)) {
+			switch (event.kind) {
+			case windowEvent::type::input:
+				lastInputTime = event.time;
+				break;
+			case windowEvent::type::resize:
+				framebufferSize = event.framebufferSize;
+				framebufferResized = true;
+				break;
+			case windowEvent::type::close:
+				closeRequested = true;
+				break;
+			}
+		}
+	}
+
+	// render thread: blocks until something new was published, for while theres nothing to draw to
+	void waitForEvents(void)
+	{
+		if (useRenderThread) {
+			std::this_thread::sleep_for(std::chrono::duration<double>(EVENT_POLL_INTERVAL));
+		} else {
+			glfwWaitEvents();
+			publishEvents();
+		}
+		drainEvents();
+	}
+	// startup as a task graph, each task starts once what it needs is there. reading and decoding the assets doesnt need
+	// vulkan at all so it runs next to instance and device creation, and the pipelines get built while the uploads run.
+	// uploads all go through the one transfer pool and queue, so they are chained instead of running side by side
 	void initVulkan(void)
 	{
-		createInstance();
-		setupDebugMessenger();
-		trianglePresentation::createSurface(vkInstance, window, &surface);
-		p_device::pickPhysicalDevice(&physicalDevice, vkInstance, surface);
-		if (physicalDevice == VK_NULL_HANDLE)
-			throw std::runtime_error("failed to find a suitable GPU");
-		//different place for below call in the tutorial
-		msaaSamples = getMaxUsableSampleCount();
-		p_device::createLogicalDevice(&device, physicalDevice, &graphicsQueue, &presentQueue, surface);
-		trianglePresentation::createSwapchain(physicalDevice, device, surface, window, swapchainInfo);
-		createImageViews();
-		// im giving up on splitting all this shit up into files. I don't know enough to properly factor this shit anyway.
-		// so im just following the tutorial now
-		createRenderPass();
-		createDescriptorSetLayout();
-		createGraphicsPipeline();
-		createCommandPools();
-		createColorResources();
-		createDepthResources();
-		createFramebuffers();
-		createTextureImage();
-		createTextureImageView();
-		createTextureSampler();
-		loadModel();
-		createVertexBuffers();
-		createIndexBuffers();
-		createUniformBuffers();
-		createDescriptorPool();
-		createDescriptorSets();
-		createCommandBuffers();
-		createSyncObjects();
+		framesInFlight = tsettings::settings.framesInFlight;
+		jobs = std::make_unique<tjobs::JobSystem>(tsettings::settings.jobThreads);
+		DecodedTexture decodedTexture{};
+		DecodedMesh decodedModel;
+		tjobs::TaskGraph startup;
+
+		auto readTexture = startup.add("read texture", {}, [&] {
+			std::vector<uint8_t> bytes = tasset::readFile(TEXTURE_PATH);
+			textureKey = tasset::hash64(bytes.data(), bytes.size());
+			decodedTexture = decodeTexture(bytes, textureKey);
+		});
+		auto readModel = startup.add("read model", {}, [&] {
+			std::vector<uint8_t> bytes = tasset::readFile(MODEL_PATH);
+			modelKey = tasset::hash64(bytes.data(), bytes.size());
+			decodedModel = decodeModel(bytes, modelKey);
+		});
+		auto instance = startup.add("instance", {}, [&] {
+			createInstance();
+			setupDebugMessenger();
+			trianglePresentation::createSurface(vkInstance, window, &surface);
+		});
+		auto logicalDevice = startup.add("device", {instance}, [&] {
+			{
+				tprofile::Scope scope("pickPhysicalDevice", tprofile::kind::stage);
+				p_device::pickPhysicalDevice(&physicalDevice, vkInstance, surface);
+			}
+			if (physicalDevice == VK_NULL_HANDLE)
+				throw std::runtime_error("failed to find a suitable GPU");
+			deviceCapabilities = p_device::queryDeviceCapabilities(physicalDevice);
+			//different place for below call in the tutorial
+			msaaSamples = getMaxUsableSampleCount();
+			{
+				tprofile::Scope scope("createLogicalDevice", tprofile::kind::stage);
+				p_device::createLogicalDevice(&device, physicalDevice, &graphicsQueue, &presentQueue, surface, deviceCapabilities);
+				DEBUG_NAME(device, VK_OBJECT_TYPE_QUEUE, graphicsQueue, "graphics queue");
+				if (presentQueue != graphicsQueue)
+					DEBUG_NAME(device, VK_OBJECT_TYPE_QUEUE, presentQueue, "present queue");
+			}
+			chooseSyncMode();
+			chooseBarrierMode();
+			chooseRenderingMode();
+			chooseBindlessMode();
+		});
+		auto swapchain = startup.add("swapchain", {logicalDevice}, [&] {
+			trianglePresentation::createSwapchain(physicalDevice, device, surface, framebufferSize, tsettings::settings.swapchainImages,
+							      VK_NULL_HANDLE, swapchainInfo);
+			createImageViews();
+			// im giving up on splitting all this shit up into files. I don't know enough to properly factor this shit anyway.
+			// so im just following the tutorial now
+			depthFormat = findDepthFormat();
+			if (!useDynamicRendering)
+				createRenderPass();
+		});
+		// the texture sampler comes first, its baked into the layouts as an immutable sampler
+		auto layouts = startup.add("layouts", {logicalDevice}, [&] {
+			createTextureSampler();
+			createDescriptorSetLayout();
+		});
+		startup.add("pipeline", {swapchain, layouts}, [&] { createGraphicsPipeline(); });
+		auto commandPools = startup.add("command pools", {logicalDevice}, [&] { createCommandPools(); });
+		startup.add("frame graph", {swapchain}, [&] {
+			buildFrameGraph();
+			if (!useDynamicRendering)
+				createFramebuffers();
+		});
+		auto mipGen = startup.add("mipgen", {commandPools}, [&] { chooseMipGenMode(); });
+		auto gpuTimers = startup.add("gpu timers", {logicalDevice}, [&] { createGpuTimers(); });
+		auto uploadTextureTask =
+		    startup.add("upload texture", {readTexture, mipGen, gpuTimers}, [&] { texture = uploadTexture(decodedTexture); });
+		startup.add("upload model", {readModel, uploadTextureTask}, [&] { model = uploadModel(decodedModel); });
+		auto uniformBuffers = startup.add("uniform buffers", {logicalDevice}, [&] { createUniformBuffers(); });
+		startup.add("descriptors", {layouts, uniformBuffers, uploadTextureTask}, [&] {
+			createDescriptorPool();
+			createDescriptorSets();
+			if (useBindless) {
+				createBindlessDescriptorSet();
+				textureIndex = registerBindlessTexture(texture->view);
+			}
+		});
+		startup.add("command buffers", {commandPools, swapchain}, [&] { createCommandBuffers(); });
+		startup.add("sync objects", {logicalDevice}, [&] { createSyncObjects(); });
+
+		startup.run(*jobs, tsettings::settings.serialStartup);
+		if (tsettings::settings.startupTrace)
+			startup.printTimeline(std::cout);
 	}
 	void mainLoop(void)
 	{
-		while (!glfwWindowShouldClose(window)) {
-			glfwPollEvents();
-			drawFrame();
+		useRenderThread = tsettings::settings.renderThread;
+		if (!useRenderThread) {
+			renderLoop();
+			vkDeviceWaitIdle(device);
+			return;
+		}
+
+		std::exception_ptr renderError;
+		std::thread renderThread([this, &renderError] {
+			if (ttrace::enabled())
+				ttrace::nameThread("render");
+			try {
+				renderLoop();
+			} catch (...) {
+				renderError = std::current_exception();
+			}
+			renderStopped = true;
+			glfwPostEmptyEvent();
+		});
+		while (!renderStopped) {
+			glfwWaitEventsTimeout(EVENT_POLL_INTERVAL);
+			publishEvents();
 		}
+		renderThread.join();
+		if (renderError)
+			std::rethrow_exception(renderError);
 		vkDeviceWaitIdle(device);
 	}
+
+	void renderLoop(void)
+	{
+		while (!closeRequested) {
+			// low latency mode samples inside drawFrame once its done waiting
+			if (!tsettings::settings.lowLatency)
+				sampleInput();
+			drawFrame();
+		}
+	}
 	void cleanup(void)
 	{
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+		for (size_t i = 0; i < framesInFlight; ++i) {
 
 			vkDestroySemaphore(device, imageAvailableSemaphores[i], nullptr);
 			vkDestroySemaphore(device, renderFinishedSemaphores[i], nullptr);
-			vkDestroyFence(device, inFlightFences[i], nullptr);
+			if (!useTimeline)
+				vkDestroyFence(device, inFlightFences[i], nullptr);
+		}
+		// the device is idle so nothing queued is in use anymore. before the command pools go, the queues hold
+		// upload and cached command buffers
+		cleanupSwapChain(false, frameNumber);
+		releaseTexture(textureKey);
+		releaseModel(modelKey);
+		frameDeletions.flushAll();
+		uploadDeletions.flushAll();
+		frameTimers.destroy(device);
+		uploadTimers.destroy(device);
+		pipelineStats.destroy(device);
+		if (useTimeline) {
+			graphicsTimeline.destroy(device);
+			transferTimeline.destroy(device);
 		}
 		vkDestroyCommandPool(device, commandPool, nullptr);
 		vkDestroyCommandPool(device, memoryTransferCommandPool, nullptr);
-		cleanupSwapChain();
-		vkDestroySampler(device, textureSampler, nullptr);
-		vkDestroyImageView(device, textureImageView, nullptr);
-		vkDestroyImage(device, textureImage, nullptr);
-		vkFreeMemory(device, textureImageMemory, nullptr);
-		vkDestroyBuffer(device, indexBuffer, nullptr);
-		vkFreeMemory(device, indexBufferMemory, nullptr);
-		vkDestroyBuffer(device, vertexBuffer, nullptr);
-		vkFreeMemory(device, vertexBufferMemory, nullptr);
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+		for (auto &framePools : recordCommandPools) {
+			for (auto pool : framePools) {
+				vkDestroyCommandPool(device, pool, nullptr);
+			}
+		}
+		jobs.reset();
+		if (useComputeMipGen) {
+			vkDestroyBuffer(device, mipGenCounterBuffer, nullptr);
+			vkFreeMemory(device, mipGenCounterBufferMemory, nullptr);
+			vkDestroyPipeline(device, mipGenPipeline, nullptr);
+			vkDestroyPipelineLayout(device, mipGenPipelineLayout, nullptr);
+			vkDestroyDescriptorSetLayout(device, mipGenDescriptorSetLayout, nullptr);
+		}
+		samplerCache.destroyAll(device);
+		for (size_t i = 0; i < framesInFlight; ++i) {
 			vkDestroyBuffer(device, uniformBuffers[i], nullptr);
 			vkFreeMemory(device, uniformBuffersMemory[i], nullptr);
+			vkDestroyBuffer(device, objectUniformBuffers[i], nullptr);
+			vkFreeMemory(device, objectUniformBuffersMemory[i], nullptr);
 		}
 		vkDestroyDescriptorPool(device, descriptorPool, nullptr);
 		vkDestroyDescriptorSetLayout(device, descriptorSetLayout, nullptr);
+		if (useBindless) {
+			vkDestroyDescriptorPool(device, bindlessDescriptorPool, nullptr);
+			vkDestroyDescriptorSetLayout(device, bindlessSetLayout, nullptr);
+		}
 		vkDestroyPipeline(device, graphicsPipeline, nullptr);
 		vkDestroyPipelineLayout(device, pipelineLayout, nullptr);
-		vkDestroyRenderPass(device, renderPass, nullptr);
+		if (!useDynamicRendering)
+			vkDestroyRenderPass(device, renderPass, nullptr);
 		vkDestroyDevice(device, nullptr);
 		if (enableValidationLayers) {
 			debugshit::destroyDebugUtilsMesssengerExt(vkInstance, debugMessenger, nullptr);
@@ -254,14 +655,32 @@ class TriangleApp
 	}
 	void setupDebugMessenger(void)
 	{
+		tprofile::Scope scope("setupDebugMessenger", tprofile::kind::stage);
 		if (!enableValidationLayers)
 			return;
 
 		if (debugshit::CreateDebugUtilsMessengerEXT(vkInstance, nullptr, &debugMessenger) != VK_SUCCESS)
 			throw std::runtime_error("Failed to set up debug messenger");
 	}
+	void applyValidationFilter(void)
+	{
+		static const VkDebugUtilsMessageSeverityFlagBitsEXT severities[] = {
+		    VK_DEBUG_UTILS_MESSAGE_SEVERITY_VERBOSE_BIT_EXT, VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT,
+		    VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT, VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT};
+		uint32_t types = tsettings::settings.validationTypes;
+		VkDebugUtilsMessageTypeFlagsEXT vkTypes = 0;
+		if (types & tsettings::VALIDATION_GENERAL)
+			vkTypes |= VK_DEBUG_UTILS_MESSAGE_TYPE_GENERAL_BIT_EXT;
+		if (types & tsettings::VALIDATION_SPEC)
+			vkTypes |= VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT;
+		if (types & tsettings::VALIDATION_PERFORMANCE)
+			vkTypes |= VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT;
+		debugshit::setMessageFilter(severities[static_cast<size_t>(tsettings::settings.validationLevel)], vkTypes);
+	}
+
 	void createInstance(void)
 	{
+		tprofile::Scope scope("createInstance", tprofile::kind::stage);
 		if (enableValidationLayers && !trequirement::checkValidationLayerSupport()) {
 			throw std::runtime_error("validation layer fucky wucky");
 		}
@@ -271,7 +690,7 @@ class TriangleApp
 		appInfo.applicationVersion = VK_MAKE_VERSION(0, 1, 0);
 		appInfo.pEngineName = "No Engine";
 		appInfo.engineVersion = VK_MAKE_VERSION(0, 0, 0);
-		appInfo.apiVersion = VK_API_VERSION_1_0;
+		appInfo.apiVersion = VK_API_VERSION_1_1; // for vkGetPhysicalDeviceFeatures2 and friends
 
 		VkInstanceCreateInfo createInfo{};
 		// basic info
@@ -299,9 +718,10 @@ class TriangleApp
 			createInfo.enabledLayerCount = 0;
 			createInfo.pNext = nullptr;
 		}
-		VkResult result = vkCreateInstance(&createInfo, nullptr, &vkInstance);
+		VkResult result = tprofile::timed("vkCreateInstance", vkCreateInstance, &createInfo, nullptr, &vkInstance);
 		if (result != VK_SUCCESS)
 			throw std::runtime_error("Creating instance went fucked\n");
+		debugshit::loadDebugUtils(vkInstance);
 	}
 
 	void createImageViews(void)
@@ -310,13 +730,16 @@ class TriangleApp
 		for (size_t i = 0; i < swapchainInfo.swapchainImages.size(); ++i) {
 			swapChainImageViews[i] =
 			    createImageView(swapchainInfo.swapchainImages[i], swapchainInfo.swapchainImageFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+			DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE, swapchainInfo.swapchainImages[i], "swapchain image " + std::to_string(i));
+			DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE_VIEW, swapChainImageViews[i], "swapchain image " + std::to_string(i));
 		}
 	}
 
 	void createGraphicsPipeline(void)
 	{
+		tprofile::Scope scope("createGraphicsPipeline", tprofile::kind::stage);
 		auto vertexShaderCode = readShaderFile("shaders/shader.vert.spv");
-		auto fragShaderCode = readShaderFile("shaders/shader.frag.spv");
+		auto fragShaderCode = readShaderFile(useBindless ? "shaders/bindless.frag.spv" : "shaders/shader.frag.spv");
 
 		VkShaderModule vertexShaderModule = createShaderModule(vertexShaderCode, device);
 		VkShaderModule fragShaderModule = createShaderModule(fragShaderCode, device);
@@ -327,6 +750,18 @@ class TriangleApp
 		vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
 		vertShaderStageInfo.module = vertexShaderModule;
 		vertShaderStageInfo.pName = "main";
+		// picks where the model matrix comes from at pipeline creation, the other path gets compiled out
+		VkBool32 modelFromPushConstant = tsettings::settings.transforms == tsettings::transformMode::push ? VK_TRUE : VK_FALSE;
+		VkSpecializationMapEntry specializationEntry{};
+		specializationEntry.constantID = 0;
+		specializationEntry.offset = 0;
+		specializationEntry.size = sizeof(modelFromPushConstant);
+		VkSpecializationInfo specializationInfo{};
+		specializationInfo.mapEntryCount = 1;
+		specializationInfo.pMapEntries = &specializationEntry;
+		specializationInfo.dataSize = sizeof(modelFromPushConstant);
+		specializationInfo.pData = &modelFromPushConstant;
+		vertShaderStageInfo.pSpecializationInfo = &specializationInfo;
 		VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
 		fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
 		fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
@@ -432,18 +867,29 @@ class TriangleApp
 		depthStencil.back = {};	 // optional
 
 		// laayout
+		std::array<VkDescriptorSetLayout, 2> setLayouts = {descriptorSetLayout, bindlessSetLayout};
+		std::array<VkPushConstantRange, 2> pushConstantRanges{};
+		pushConstantRanges[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		pushConstantRanges[0].offset = offsetof(DrawPushConstants, model);
+		pushConstantRanges[0].size = sizeof(glm::mat4);
+		pushConstantRanges[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		pushConstantRanges[1].offset = offsetof(DrawPushConstants, textureIndex);
+		pushConstantRanges[1].size = sizeof(uint32_t);
+
 		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo;
 		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		pipelineLayoutCreateInfo.setLayoutCount = 1;
-		pipelineLayoutCreateInfo.pSetLayouts = &descriptorSetLayout;
-		pipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-		pipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
+		pipelineLayoutCreateInfo.setLayoutCount = useBindless ? 2 : 1;
+		pipelineLayoutCreateInfo.pSetLayouts = setLayouts.data();
+		// texture index only exists in the bindless fragment shader
+		pipelineLayoutCreateInfo.pushConstantRangeCount = useBindless ? 2 : 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = pushConstantRanges.data();
 		pipelineLayoutCreateInfo.pNext = nullptr; // based on validation layer output
 		pipelineLayoutCreateInfo.flags = VK_PIPELINE_LAYOUT_CREATE_INDEPENDENT_SETS_BIT_EXT;
 
-		if (vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreatePipelineLayout", vkCreatePipelineLayout, device, &pipelineLayoutCreateInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to make pipeline layout");
 		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_PIPELINE_LAYOUT, pipelineLayout, "scene pipeline layout");
 
 		// FINALLY
 		VkGraphicsPipelineCreateInfo pipelineInfo{};
@@ -459,14 +905,24 @@ class TriangleApp
 		pipelineInfo.pColorBlendState = &colorBlendGlobal;
 		pipelineInfo.pDynamicState = &dynamicStateCreateInfo;
 		pipelineInfo.layout = pipelineLayout;
+		// without a render pass the pipeline gets told the attachment formats directly
+		VkPipelineRenderingCreateInfoKHR renderingCreateInfo{};
+		renderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+		renderingCreateInfo.colorAttachmentCount = 1;
+		renderingCreateInfo.pColorAttachmentFormats = &swapchainInfo.swapchainImageFormat;
+		renderingCreateInfo.depthAttachmentFormat = depthFormat;
+		renderingCreateInfo.stencilAttachmentFormat = hasStencilComponent(depthFormat) ? depthFormat : VK_FORMAT_UNDEFINED;
+		if (useDynamicRendering)
+			pipelineInfo.pNext = &renderingCreateInfo;
 		pipelineInfo.renderPass = renderPass;
 		pipelineInfo.subpass = 0;
 		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 		pipelineInfo.basePipelineIndex = -1;
 
-		if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateGraphicsPipelines", vkCreateGraphicsPipelines, device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create graphics pipeline");
 		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_PIPELINE, graphicsPipeline, useBindless ? "scene pipeline (bindless)" : "scene pipeline");
 
 		// wut?
 		vkDestroyShaderModule(device, fragShaderModule, nullptr);
@@ -482,7 +938,8 @@ class TriangleApp
 		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		// the frame graph transitions every attachment before and after the pass, so the render pass itself never changes a layout
+		colorAttachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		colorAttachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference colorAttachmentRef{};
@@ -490,13 +947,13 @@ class TriangleApp
 		colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentDescription depthAttachment{};
-		depthAttachment.format = findDepthFormat();
+		depthAttachment.format = depthFormat;
 		depthAttachment.samples = msaaSamples;
 		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
 		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 		depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 		depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference depthAttachmentRef{};
@@ -510,8 +967,8 @@ class TriangleApp
 		colorAttachmentResolve.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		colorAttachmentResolve.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 		colorAttachmentResolve.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-		colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-		colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		colorAttachmentResolve.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachmentResolve.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 		VkAttachmentReference colorAttachmentResolveRef{};
 		colorAttachmentResolveRef.attachment = 2;
@@ -524,14 +981,6 @@ class TriangleApp
 		subpass.pDepthStencilAttachment = &depthAttachmentRef;
 		subpass.pResolveAttachments = & colorAttachmentResolveRef;
 
-		VkSubpassDependency dependency{};
-		dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-		dependency.dstSubpass = 0;
-		dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		dependency.srcAccessMask = 0;
-		dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
 		std::array<VkAttachmentDescription, 3> attachments = {colorAttachment, depthAttachment, colorAttachmentResolve};
 		VkRenderPassCreateInfo renderPassInfo{};
 		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
@@ -539,19 +988,21 @@ class TriangleApp
 		renderPassInfo.pAttachments = attachments.data();
 		renderPassInfo.subpassCount = 1;
 		renderPassInfo.pSubpasses = &subpass;
-		renderPassInfo.dependencyCount = 1;
-		renderPassInfo.pDependencies = &dependency;
+		// no subpass dependencies either, the graph barriers around the pass already order it against the acquire and present
+		renderPassInfo.dependencyCount = 0;
+		renderPassInfo.pDependencies = nullptr;
 
-		if (vkCreateRenderPass(device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateRenderPass", vkCreateRenderPass, device, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create render pass");
 		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_RENDER_PASS, renderPass, "scene render pass");
 	}
 
 	void createFramebuffers(void)
 	{
 		swapChainFramebuffers.resize(swapChainImageViews.size());
 		for (size_t i = 0; i < swapChainImageViews.size(); ++i) {
-			std::array<VkImageView, 3> attachments = {colorImageView, depthImageView, swapChainImageViews[i]};
+			std::array<VkImageView, 3> attachments = {frameGraph.imageView(sceneColor), frameGraph.imageView(sceneDepth), swapChainImageViews[i]};
 			VkFramebufferCreateInfo framebufferInfo{};
 			framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
 			framebufferInfo.renderPass = renderPass;
@@ -561,9 +1012,127 @@ class TriangleApp
 			framebufferInfo.height = swapchainInfo.swapchainExtent.height;
 			framebufferInfo.layers = 1;
 
-			if (vkCreateFramebuffer(device, &framebufferInfo, nullptr, &swapChainFramebuffers[i]) != VK_SUCCESS) {
+			if (tprofile::timed("vkCreateFramebuffer", vkCreateFramebuffer, device, &framebufferInfo, nullptr, &swapChainFramebuffers[i]) != VK_SUCCESS) {
 				throw std::runtime_error("FUCKY WUCKY when make a framebuffer");
 			}
+			DEBUG_NAME(device, VK_OBJECT_TYPE_FRAMEBUFFER, swapChainFramebuffers[i], "scene framebuffer " + std::to_string(i));
+		}
+	}
+
+	// msaa color + depth, resolved into the swapchain image. the graph only knows what the pass touches, the pass
+	// records its own render pass
+	void buildFrameGraph(void)
+	{
+		tprofile::Scope scope("buildFrameGraph", tprofile::kind::stage);
+		VkExtent2D extent = swapchainInfo.swapchainExtent;
+		VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT | (hasStencilComponent(depthFormat) ? VK_IMAGE_ASPECT_STENCIL_BIT : 0);
+
+		swapchainTarget = frameGraph.importImage("swapchain", VK_IMAGE_ASPECT_COLOR_BIT, tgraph::access::acquired, tgraph::access::present);
+		meshVertices = frameGraph.importBuffer("vertices");
+		meshIndices = frameGraph.importBuffer("indices");
+		sceneColor = frameGraph.createImage("scene color", {swapchainInfo.swapchainImageFormat, extent, msaaSamples,
+								    VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT});
+		sceneDepth = frameGraph.createImage("scene depth", {depthFormat, extent, msaaSamples, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, depthAspect});
+
+		frameGraph.addPass("scene",
+				   {{sceneColor, tgraph::access::colorAttachmentWrite},
+				    {sceneDepth, tgraph::access::depthAttachmentWrite},
+				    {swapchainTarget, tgraph::access::colorAttachmentWrite},
+				    {meshVertices, tgraph::access::vertexBufferRead},
+				    {meshIndices, tgraph::access::indexBufferRead}},
+				   [this](VkCommandBuffer buffer) {
+			// workers record the draws into secondaries, those have to be executed inside the pass
+			bool secondaries = recordChunkCount > 0;
+			// outside the pass so the query covers the secondaries too
+			bool counting = countingPipelineStats();
+			if (counting)
+				pipelineStats.begin(buffer, currentFrame);
+			beginScenePass(buffer, secondaries);
+			uint32_t drawCount = static_cast<uint32_t>(drawTransforms.size());
+			if (secondaries) {
+				recordSecondaryDraws(recordingImageIndex, drawCount);
+				std::vector<VkCommandBuffer> &recorded = recordSecondaryBuffers[currentFrame];
+				vkCmdExecuteCommands(buffer, static_cast<uint32_t>(recorded.size()), recorded.data());
+			} else {
+				recordDraws(buffer, 0, drawCount);
+			}
+			endScenePass(buffer);
+			if (counting)
+				pipelineStats.end(buffer, currentFrame);
+		});
+
+		VkPhysicalDeviceMemoryProperties memProperties;
+		vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
+		frameGraph.compile(device, memProperties);
+		std::cout << "frame graph: " << frameGraph.keptPassCount() << " passes (" << frameGraph.culledPassCount() << " culled), "
+			  << frameGraph.barrierCount() << " barriers (" << (tgraph::usingSynchronization2() ? "sync2" : "legacy") << "), "
+			  << frameGraph.transientBytes() / 1024 << " KiB transient memory, " << frameGraph.aliasedBytes() / 1024 << " KiB saved by aliasing"
+			  << std::endl;
+	}
+
+	void beginScenePass(VkCommandBuffer buffer, bool secondaries)
+	{
+		VkClearValue clearColor{};
+		clearColor.color = {{0.0f, 0.0f, 0.0f, 1.0f}};
+		VkClearValue clearDepth{};
+		clearDepth.depthStencil = {1.0f, 0};
+
+		if (!useDynamicRendering) {
+			VkRenderPassBeginInfo renderPassInfo{};
+			renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			renderPassInfo.renderPass = renderPass;
+			renderPassInfo.framebuffer = swapChainFramebuffers[recordingImageIndex];
+			renderPassInfo.renderArea.offset = {0, 0};
+			renderPassInfo.renderArea.extent = swapchainInfo.swapchainExtent;
+			std::array<VkClearValue, 2> clearValues = {clearColor, clearDepth};
+			renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
+			renderPassInfo.pClearValues = clearValues.data();
+			vkCmdBeginRenderPass(buffer, &renderPassInfo, secondaries ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+			return;
+		}
+
+		// same attachments and ops as createRenderPass, the msaa color gets resolved into the swapchain image at the end
+		VkRenderingAttachmentInfoKHR colorAttachment{};
+		colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+		colorAttachment.imageView = frameGraph.imageView(sceneColor);
+		colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachment.resolveMode = VK_RESOLVE_MODE_AVERAGE_BIT_KHR;
+		colorAttachment.resolveImageView = swapChainImageViews[recordingImageIndex];
+		colorAttachment.resolveImageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		colorAttachment.clearValue = clearColor;
+
+		VkRenderingAttachmentInfoKHR depthAttachment{};
+		depthAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+		depthAttachment.imageView = frameGraph.imageView(sceneDepth);
+		depthAttachment.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		depthAttachment.clearValue = clearDepth;
+		// the pipeline was told about the stencil aspect, so it has to be bound too even though nothing uses it
+		VkRenderingAttachmentInfoKHR stencilAttachment = depthAttachment;
+		stencilAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+
+		VkRenderingInfoKHR renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+		renderingInfo.flags = secondaries ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+		renderingInfo.renderArea.offset = {0, 0};
+		renderingInfo.renderArea.extent = swapchainInfo.swapchainExtent;
+		renderingInfo.layerCount = 1;
+		renderingInfo.colorAttachmentCount = 1;
+		renderingInfo.pColorAttachments = &colorAttachment;
+		renderingInfo.pDepthAttachment = &depthAttachment;
+		renderingInfo.pStencilAttachment = hasStencilComponent(depthFormat) ? &stencilAttachment : nullptr;
+		cmdBeginRendering(buffer, &renderingInfo);
+	}
+
+	void endScenePass(VkCommandBuffer buffer)
+	{
+		if (useDynamicRendering) {
+			cmdEndRendering(buffer);
+		} else {
+			vkCmdEndRenderPass(buffer);
 		}
 	}
 
@@ -574,9 +1143,10 @@ class TriangleApp
 		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 		poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
 		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
-		if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateCommandPool", vkCreateCommandPool, device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create command pool");
 		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_COMMAND_POOL, commandPool, "frame command pool");
 
 		VkCommandPoolCreateInfo memPoolInfo{};
 		memPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
@@ -584,23 +1154,117 @@ class TriangleApp
 		poolInfo.queueFamilyIndex =
 		    queueFamilyIndices.graphicsFamily
 			.value(); // this queue supports mem transfer implicitly, its possible to use a seperate queue JUST for mem transfers
-		if (vkCreateCommandPool(device, &memPoolInfo, nullptr, &memoryTransferCommandPool) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateCommandPool", vkCreateCommandPool, device, &memPoolInfo, nullptr, &memoryTransferCommandPool) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create memory transfer command pool");
 		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_COMMAND_POOL, memoryTransferCommandPool, "upload command pool");
 	}
 
 	void createCommandBuffers(void)
 	{
-		commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+		commandBuffers.resize(framesInFlight);
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
 		allocInfo.commandPool = commandPool;
 		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-		allocInfo.commandBufferCount = (uint32_t)MAX_FRAMES_IN_FLIGHT;
+		allocInfo.commandBufferCount = framesInFlight;
 
 		if (vkAllocateCommandBuffers(device, &allocInfo, commandBuffers.data()) != VK_SUCCESS) {
 			throw std::runtime_error("failed to allocate command buffers");
 		}
+		for (uint32_t i = 0; i < framesInFlight; ++i) {
+			DEBUG_NAME(device, VK_OBJECT_TYPE_COMMAND_BUFFER, commandBuffers[i], "frame " + std::to_string(i));
+		}
+
+		if (tsettings::settings.cacheCommands) {
+			// anything pushed while recording gets baked in, so per draw transforms have to come from the uniform ring
+			if (tsettings::settings.transforms == tsettings::transformMode::push)
+				throw std::runtime_error("--cache-commands needs --transforms=dynamic, push constants would be frozen in the cached commands");
+			// the secondaries get reset every frame, cached primaries would end up pointing at stale ones
+			if (tsettings::settings.recordThreads > 0)
+				throw std::runtime_error("--cache-commands and --record-threads cant be used together");
+			useCommandCache = true;
+			invalidateCommandCache();
+		}
+
+		if (tsettings::settings.recordThreads > 0)
+			createRecordChunks(tsettings::settings.recordThreads);
+	}
+
+	void createRecordChunks(uint32_t chunkCount)
+	{
+		recordChunkCount = chunkCount;
+		p_device::QueueFamilyIndices queueFamilyIndices = trequirement::findQueuFamilies(physicalDevice, surface);
+
+		// command pools arent thread safe, so each chunk gets its own. one per frame in flight too so a whole pool can be
+		// reset at once when its frame comes around again, thats cheaper than resetting buffers one by one
+		VkCommandPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+
+		recordCommandPools.assign(framesInFlight, std::vector<VkCommandPool>(chunkCount));
+		recordSecondaryBuffers.assign(framesInFlight, std::vector<VkCommandBuffer>(chunkCount));
+		for (size_t frame = 0; frame < framesInFlight; ++frame) {
+			for (uint32_t chunk = 0; chunk < chunkCount; ++chunk) {
+				if (tprofile::timed("vkCreateCommandPool", vkCreateCommandPool, device, &poolInfo, nullptr, &recordCommandPools[frame][chunk]) != VK_SUCCESS) {
+					throw std::runtime_error("failed to create recording command pool");
+				}
+				VkCommandBufferAllocateInfo allocInfo{};
+				allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				allocInfo.commandPool = recordCommandPools[frame][chunk];
+				allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+				allocInfo.commandBufferCount = 1;
+				if (vkAllocateCommandBuffers(device, &allocInfo, &recordSecondaryBuffers[frame][chunk]) != VK_SUCCESS) {
+					throw std::runtime_error("failed to allocate secondary command buffer");
+				}
+				DEBUG_NAME(device, VK_OBJECT_TYPE_COMMAND_BUFFER, recordSecondaryBuffers[frame][chunk],
+					   "frame " + std::to_string(frame) + " draws " + std::to_string(chunk));
+			}
+		}
+	}
+
+	// throws away every cached command buffer, call it whenever something recorded into them changes (swapchain, pipeline,
+	// the scene). the buffers must not be in use, recreateSwapChain hands them to the retired swapchain before calling this
+	void invalidateCommandCache(void)
+	{
+		if (!cachedCommandBuffers.empty()) {
+			vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(cachedCommandBuffers.size()), cachedCommandBuffers.data());
+		}
+		// the image count can change with the swapchain so reallocate instead of just resetting
+		cachedCommandBuffers.resize(framesInFlight * swapchainInfo.swapchainImages.size());
+		cachedCommandBufferValid.assign(cachedCommandBuffers.size(), false);
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = static_cast<uint32_t>(cachedCommandBuffers.size());
+		if (vkAllocateCommandBuffers(device, &allocInfo, cachedCommandBuffers.data()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate cached command buffers");
+		}
+		for (size_t slot = 0; slot < cachedCommandBuffers.size(); ++slot) {
+			DEBUG_NAME(device, VK_OBJECT_TYPE_COMMAND_BUFFER, cachedCommandBuffers[slot],
+				   "frame " + std::to_string(slot / swapchainInfo.swapchainImages.size()) + " image " +
+				       std::to_string(slot % swapchainInfo.swapchainImages.size()) + " (cached)");
+		}
+	}
+
+	// the command buffer to submit this frame, recorded now unless a valid cached one exists
+	VkCommandBuffer prepareCommandBuffer(uint32_t imageIndex)
+	{
+		VkCommandBuffer buffer = commandBuffers[currentFrame];
+		if (useCommandCache) {
+			size_t slot = currentFrame * swapchainInfo.swapchainImages.size() + imageIndex;
+			buffer = cachedCommandBuffers[slot];
+			// only ever submitted together with this frames fence which we just waited on, so its not pending anymore
+			if (cachedCommandBufferValid[slot])
+				return buffer;
+			cachedCommandBufferValid[slot] = true;
+		}
+		vkResetCommandBuffer(buffer, 0);
+		recordCommandBuffer(buffer, imageIndex);
+		return buffer;
 	}
 
 	void recordCommandBuffer(VkCommandBuffer buffer, uint32_t imageIndex)
@@ -615,24 +1279,89 @@ class TriangleApp
 			    "are we really going to be throwing exceptions in functions like this?, failed to begin recording command buffer");
 		}
 
-		VkRenderPassBeginInfo renderPassInfo{};
-		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		renderPassInfo.renderPass = renderPass;
-		renderPassInfo.framebuffer = swapChainFramebuffers[imageIndex];
-		renderPassInfo.renderArea.offset = {0, 0};
-		renderPassInfo.renderArea.extent = swapchainInfo.swapchainExtent;
-		std::array<VkClearValue, 2> clearValues{};
-		clearValues[0].color = {{0.0f, 0.0f, 0.0f, 1.0f}};
-		clearValues[1].depthStencil = {1.0f, 0};
-		renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
-		renderPassInfo.pClearValues = clearValues.data();
-		vkCmdBeginRenderPass(buffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+		frameGraph.setImportedImage(swapchainTarget, swapchainInfo.swapchainImages[imageIndex]);
+		frameGraph.setImportedBuffer(meshVertices, model->vertexBuffer);
+		frameGraph.setImportedBuffer(meshIndices, model->indexBuffer);
+		recordingImageIndex = imageIndex;
+		// the frame is timed as a whole and every pass on its own
+		frameTimers.beginSlot(buffer, currentFrame);
+		if (countingPipelineStats())
+			pipelineStats.reset(buffer, currentFrame);
+		uint32_t frameScope = frameTimers.begin(buffer, currentFrame, "frame");
+		tgraph::passHooks timePasses;
+		timePasses.before = [this](VkCommandBuffer commandBuffer, const std::string &pass) {
+			passTimerScope = frameTimers.begin(commandBuffer, currentFrame, "pass " + pass);
+		};
+		timePasses.after = [this](VkCommandBuffer commandBuffer, const std::string &) { frameTimers.end(commandBuffer, currentFrame, passTimerScope); };
+		frameGraph.execute(buffer, frameTimers.enabled() ? &timePasses : nullptr);
+		frameTimers.end(buffer, currentFrame, frameScope);
+		if (vkEndCommandBuffer(buffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record command buffer");
+		}
+	}
+
+	// every chunk records an even slice of the draws into its secondary buffer for this frame, one job per chunk. a chunk
+	// only ever runs on one thread at a time so its pool needs no locking
+	void recordSecondaryDraws(uint32_t imageIndex, uint32_t drawCount)
+	{
+		jobs->parallelFor(recordChunkCount, 1, [&](uint32_t firstChunk, uint32_t endChunk) {
+			for (uint32_t chunk = firstChunk; chunk < endChunk; ++chunk) {
+				recordSecondaryChunk(imageIndex, drawCount, chunk);
+			}
+		});
+	}
 
+	void recordSecondaryChunk(uint32_t imageIndex, uint32_t drawCount, uint32_t chunk)
+	{
+		uint32_t firstDraw = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * chunk / recordChunkCount);
+		uint32_t endDraw = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * (chunk + 1) / recordChunkCount);
+		// the pool was last used framesInFlight frames ago and that frames fence has been waited on
+		vkResetCommandPool(device, recordCommandPools[currentFrame][chunk], 0);
+
+		VkCommandBufferInheritanceInfo inheritanceInfo{};
+		inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		// dynamic rendering has no render pass to inherit, the secondary gets the attachment formats instead
+		VkCommandBufferInheritanceRenderingInfoKHR renderingInheritance{};
+		renderingInheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+		renderingInheritance.colorAttachmentCount = 1;
+		renderingInheritance.pColorAttachmentFormats = &swapchainInfo.swapchainImageFormat;
+		renderingInheritance.depthAttachmentFormat = depthFormat;
+		renderingInheritance.stencilAttachmentFormat = hasStencilComponent(depthFormat) ? depthFormat : VK_FORMAT_UNDEFINED;
+		renderingInheritance.rasterizationSamples = msaaSamples;
+		if (useDynamicRendering) {
+			inheritanceInfo.pNext = &renderingInheritance;
+		} else {
+			inheritanceInfo.renderPass = renderPass;
+			inheritanceInfo.subpass = 0;
+			inheritanceInfo.framebuffer = swapChainFramebuffers[imageIndex];
+		}
+		if (countingPipelineStats())
+			inheritanceInfo.pipelineStatistics = tgputime::PIPELINE_STATISTICS;
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+		VkCommandBuffer secondary = recordSecondaryBuffers[currentFrame][chunk];
+		if (vkBeginCommandBuffer(secondary, &beginInfo) != VK_SUCCESS) {
+			throw std::runtime_error("failed to begin recording secondary command buffer");
+		}
+		// secondaries dont inherit any state from the primary, so each one sets everything up again
+		recordDraws(secondary, firstDraw, endDraw - firstDraw);
+		if (vkEndCommandBuffer(secondary) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record secondary command buffer");
+		}
+	}
+
+	// binds everything the draws need and records drawCount draws starting at firstDraw, inside an already begun render pass
+	void recordDraws(VkCommandBuffer buffer, uint32_t firstDraw, uint32_t drawCount)
+	{
 		vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
-		VkBuffer vertexBuffers[] = {vertexBuffer};
+		VkBuffer vertexBuffers[] = {model->vertexBuffer};
 		VkDeviceSize offsets[] = {0};
 		vkCmdBindVertexBuffers(buffer, 0, 1, vertexBuffers, offsets);
-		vkCmdBindIndexBuffer(buffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+		vkCmdBindIndexBuffer(buffer, model->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
 		// scissor and viewport size are dynamic so set them now
 		VkViewport viewport{};
@@ -650,70 +1379,240 @@ class TriangleApp
 
 		// pre-index
 		// vkCmdDraw(buffer, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
-		vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 0, nullptr);
-		vkCmdDrawIndexed(buffer, static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-		vkCmdEndRenderPass(buffer);
-		if (vkEndCommandBuffer(buffer) != VK_SUCCESS) {
-			throw std::runtime_error("failed to record command buffer");
+		uint32_t noDynamicOffset = 0;
+		if (useBindless) {
+			// the texture table is bound once, switching textures between draws is just a push constant
+			std::array<VkDescriptorSet, 2> sets = {descriptorSets[currentFrame], bindlessDescriptorSet};
+			vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, static_cast<uint32_t>(sets.size()), sets.data(), 1,
+						&noDynamicOffset);
+			vkCmdPushConstants(buffer, pipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, offsetof(DrawPushConstants, textureIndex), sizeof(uint32_t),
+					   &textureIndex);
+		} else {
+			vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 1, &noDynamicOffset);
+		}
+
+		bool pushTransforms = tsettings::settings.transforms == tsettings::transformMode::push;
+		for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; ++draw) {
+			if (pushTransforms) {
+				vkCmdPushConstants(buffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, offsetof(DrawPushConstants, model), sizeof(glm::mat4),
+						   &drawTransforms[draw]);
+			} else {
+				// rebinding set 0 with a new offset leaves set 1 alone
+				uint32_t dynamicOffset = static_cast<uint32_t>(draw * objectUniformStride);
+				vkCmdBindDescriptorSets(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1, &descriptorSets[currentFrame], 1,
+							&dynamicOffset);
+			}
+			vkCmdDrawIndexed(buffer, model->indexCount, 1, 0, 0, 0);
+		}
+	}
+
+	void chooseSyncMode(void)
+	{
+		switch (tsettings::settings.sync) {
+		case tsettings::syncMode::automatic:
+			useTimeline = deviceCapabilities.timelineSemaphore;
+			break;
+		case tsettings::syncMode::timeline:
+			if (!deviceCapabilities.timelineSemaphore)
+				throw std::runtime_error("Device does not support timeline semaphores");
+			useTimeline = true;
+			break;
+		case tsettings::syncMode::fences:
+			useTimeline = false;
+			break;
+		}
+		// created this early because uploads during init already signal the transfer timeline
+		if (useTimeline) {
+			ttimeline::loadFunctions(device);
+			graphicsTimeline.create(device);
+			transferTimeline.create(device);
 		}
 	}
 
+	void chooseBarrierMode(void)
+	{
+		bool useSync2 = false;
+		switch (tsettings::settings.barriers) {
+		case tsettings::barrierMode::automatic:
+			useSync2 = deviceCapabilities.synchronization2;
+			break;
+		case tsettings::barrierMode::sync2:
+			if (!deviceCapabilities.synchronization2)
+				throw std::runtime_error("Device does not support VK_KHR_synchronization2");
+			useSync2 = true;
+			break;
+		case tsettings::barrierMode::legacy:
+			useSync2 = false;
+			break;
+		}
+		tgraph::init(device, useSync2);
+	}
+
+	void chooseRenderingMode(void)
+	{
+		switch (tsettings::settings.rendering) {
+		case tsettings::renderingMode::automatic:
+			useDynamicRendering = deviceCapabilities.dynamicRendering;
+			break;
+		case tsettings::renderingMode::dynamic:
+			if (!deviceCapabilities.dynamicRendering)
+				throw std::runtime_error("Device does not support VK_KHR_dynamic_rendering");
+			useDynamicRendering = true;
+			break;
+		case tsettings::renderingMode::renderpass:
+			useDynamicRendering = false;
+			break;
+		}
+		if (!useDynamicRendering)
+			return;
+		cmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(device, "vkCmdBeginRenderingKHR");
+		cmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(device, "vkCmdEndRenderingKHR");
+		if (cmdBeginRendering == nullptr || cmdEndRendering == nullptr)
+			throw std::runtime_error("Failed to load VK_KHR_dynamic_rendering functions");
+	}
+
 	void createSyncObjects(void)
 	{
-		imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-		inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
+		// acquire and present only take binary semaphores, so those stay per frame even with timelines
+		imageAvailableSemaphores.resize(framesInFlight);
+		renderFinishedSemaphores.resize(framesInFlight);
+		frameTimelineValues.assign(framesInFlight, 0);
+		frameInputTimes.resize(framesInFlight);
+		frameRetirePending.assign(framesInFlight, false);
 
 		VkSemaphoreCreateInfo semaphoreInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
 		VkFenceCreateInfo fenceInfo{.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
 		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+		for (size_t i = 0; i < framesInFlight; ++i) {
 
-			auto s1 = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]);
-			auto s2 = vkCreateSemaphore(device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]);
-			auto s3 = vkCreateFence(device, &fenceInfo, nullptr, &inFlightFences[i]);
-			if (s1 != VK_SUCCESS || s2 != VK_SUCCESS || s3 != VK_SUCCESS) {
+			auto s1 = tprofile::timed("vkCreateSemaphore", vkCreateSemaphore, device, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]);
+			auto s2 = tprofile::timed("vkCreateSemaphore", vkCreateSemaphore, device, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]);
+			if (s1 != VK_SUCCESS || s2 != VK_SUCCESS) {
+				throw std::runtime_error("failed to create sync objects");
+			}
+		}
+		if (useTimeline)
+			return;
+		inFlightFences.resize(framesInFlight);
+		for (size_t i = 0; i < framesInFlight; ++i) {
+			if (tprofile::timed("vkCreateFence", vkCreateFence, device, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
 				throw std::runtime_error("failed to create sync objects");
 			}
 		}
 	}
 
+	// waits until the gpu is done with the last frame that used the current frame slot
+	void waitForFrameSlot(void)
+	{
+		TRACE_ZONE("wait for frame slot");
+		if (useTimeline) {
+			graphicsTimeline.wait(device, frameTimelineValues[currentFrame]);
+		} else {
+			vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+		}
+	}
+
+	// takes the newest input the event thread published, without a render thread this is where events get polled
+	void sampleInput(void)
+	{
+		if (!useRenderThread) {
+			glfwPollEvents();
+			publishEvents();
+		}
+		drainEvents();
+	}
+
 	void drawFrame(void)
 	{
-		vkWaitForFences(device, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+		TRACE_ZONE("drawFrame");
+		if (analyzingStalls())
+			stalls.frameStart();
+		countApiCalls();
+		auto slotWaitStart = std::chrono::steady_clock::now();
+		waitForFrameSlot();
+		recordStall(tstall::wait::frameSlot, slotWaitStart);
+		frameTimers.collect(device, currentFrame);
+		pipelineStats.collect(device, currentFrame);
+		recordRetireLatency();
+		collectFinishedUploads();
+		// the slot wait means every frame up to this one minus framesInFlight is done
+		frameDeletions.flush(frameNumber + 1 >= framesInFlight ? frameNumber + 1 - framesInFlight : 0);
+		TRACE_COUNTER("pending frame deletions", frameDeletions.size());
+		TRACE_COUNTER("pending upload deletions", uploadDeletions.size());
 		uint32_t imageIndex;
-		VkResult result =
-		    vkAcquireNextImageKHR(device, swapchainInfo.swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE, &imageIndex);
+		VkResult result;
+		{
+			TRACE_ZONE("acquire");
+			auto acquireStart = std::chrono::steady_clock::now();
+			result = vkAcquireNextImageKHR(device, swapchainInfo.swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame], VK_NULL_HANDLE,
+						       &imageIndex);
+			recordStall(tstall::wait::acquire, acquireStart);
+		}
 		if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-			recreateSwapChain();
+			// nothing of this frame was submitted
+			recreateSwapChain(frameNumber);
 			return;
 		} else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
 			throw std::runtime_error("Failed to acquire swap chain image");
 		}
-		vkResetFences(device, 1, &inFlightFences[currentFrame]);
-		vkResetCommandBuffer(commandBuffers[currentFrame], 0);
-		recordCommandBuffer(commandBuffers[currentFrame], imageIndex);
-
+		if (!useTimeline)
+			vkResetFences(device, 1, &inFlightFences[currentFrame]);
+		// both the fence and the acquire can block for most of a frame, input sampled before them is already that old
+		if (tsettings::settings.lowLatency)
+			sampleInput();
+		frameInputTimes[currentFrame] = lastInputTime;
+
+		auto cpuStart = std::chrono::high_resolution_clock::now();
 		updateUniformBuffer(currentFrame);
+		VkCommandBuffer frameCommandBuffer;
+		{
+			TRACE_ZONE("record");
+			frameCommandBuffer = prepareCommandBuffer(imageIndex);
+		}
+		reportDrawCost(std::chrono::high_resolution_clock::now() - cpuStart);
 
 		VkSubmitInfo submitInfo{};
 		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-		VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-		VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-		submitInfo.waitSemaphoreCount = 1;
+		// the transfer wait makes everything uploaded so far visible to the frame, uploads no longer idle the queue.
+		// it blocks vertex input and every stage after it, the swapchain image is only needed at color output
+		VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame], transferTimeline.handle()};
+		VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT};
+		submitInfo.waitSemaphoreCount = useTimeline ? 2 : 1;
 		submitInfo.pWaitSemaphores = waitSemaphores;
 		submitInfo.pWaitDstStageMask = waitStages;
 		submitInfo.commandBufferCount = 1;
-		submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
+		submitInfo.pCommandBuffers = &frameCommandBuffer;
 
-		VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-		submitInfo.signalSemaphoreCount = 1;
+		VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame], graphicsTimeline.handle()};
+		submitInfo.signalSemaphoreCount = useTimeline ? 2 : 1;
 		submitInfo.pSignalSemaphores = signalSemaphores;
 
-		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
-			throw std::runtime_error("failed to submit draw command buffer");
+		// binary semaphores ignore their value, 0 is just a placeholder
+		uint64_t waitValues[] = {0, transferTimeline.lastSignalValue()};
+		uint64_t signalValues[] = {0, 0};
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		VkFence submitFence = VK_NULL_HANDLE;
+		if (useTimeline) {
+			signalValues[1] = frameTimelineValues[currentFrame] = graphicsTimeline.reserve();
+			timelineInfo.waitSemaphoreValueCount = 2;
+			timelineInfo.pWaitSemaphoreValues = waitValues;
+			timelineInfo.signalSemaphoreValueCount = 2;
+			timelineInfo.pSignalSemaphoreValues = signalValues;
+			submitInfo.pNext = &timelineInfo;
+		} else {
+			submitFence = inFlightFences[currentFrame];
+		}
+
+		{
+			TRACE_ZONE("submit");
+			if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, submitFence) != VK_SUCCESS) {
+				throw std::runtime_error("failed to submit draw command buffer");
+			}
 		}
+		frameTimers.submitted(currentFrame);
+		pipelineStats.submitted(currentFrame);
 
 		VkPresentInfoKHR presentInfo{};
 		presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -727,104 +1626,122 @@ class TriangleApp
 		presentInfo.pResults = nullptr;
 
 		// omg finally
-		result = vkQueuePresentKHR(presentQueue, &presentInfo);
+		{
+			TRACE_ZONE("present");
+			auto presentStart = std::chrono::steady_clock::now();
+			result = vkQueuePresentKHR(presentQueue, &presentInfo);
+			recordStall(tstall::wait::present, presentStart);
+		}
+		recordPresentLatency();
+		reportGpuTime();
+		reportPipelineStats();
+		if (analyzingStalls() && ++stallFrames >= STATS_REPORT_INTERVAL) {
+			stalls.logLine(std::cout);
+			stallFrames = 0;
+		}
 		// subotimal here = we just recreate the swap chain before the next draw
 		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || framebufferResized) {
-			framebufferResized = false;
-			recreateSwapChain();
+			// this frame is submitted already and still renders to the old swapchain
+			recreateSwapChain(frameNumber + 1);
 		} else if (result != VK_SUCCESS) {
 			throw std::runtime_error("failed to present swap chain image");
 		}
-		currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+		currentFrame = (currentFrame + 1) % framesInFlight;
+		++frameNumber;
 	}
 
-	void recreateSwapChain(void)
+	// submittedFrames is how many frames went to the queue so far, the current one included if it was submitted.
+	// everything replaced here is only destroyed once all of them are done
+	void recreateSwapChain(uint64_t submittedFrames)
 	{
-		int width = 0;
-		int height = 0;
-		glfwGetFramebufferSize(window, &width, &height);
-		while (width == 0 || height == 0) {
-			// following tutorial but shouldnt the order be reversed?
-			glfwGetFramebufferSize(window, &width, &height);
-			glfwWaitEvents();
+		// minimized, nothing to draw to until a resize message says otherwise
+		while (framebufferSize.width == 0 || framebufferSize.height == 0) {
+			if (closeRequested)
+				return;
+			waitForEvents();
 		}
-		vkDeviceWaitIdle(device);
-
-		cleanupSwapChain();
+		framebufferResized = false;
+		// new framebuffers and command buffers get created in the next frames, those arent steady state
+		apiWarmupFrames = API_COUNTER_WARMUP_FRAMES;
+		apiHavePrevious = false;
+
+		// no device wait, frames still in flight keep rendering to the old swapchain. it goes to the driver as
+		// oldSwapchain and gets destroyed together with everything built on it once those frames are done
+		trianglePresentation::swapchainInformation replacement;
+		trianglePresentation::createSwapchain(physicalDevice, device, surface, framebufferSize, tsettings::settings.swapchainImages,
+						      swapchainInfo.swapchain, replacement);
+		// the msaa color and depth targets only depend on extent and format, a suboptimal present or a resize back to
+		// the same size keeps them
+		bool keepFrameGraph = replacement.swapchainExtent.width == swapchainInfo.swapchainExtent.width &&
+				      replacement.swapchainExtent.height == swapchainInfo.swapchainExtent.height &&
+				      replacement.swapchainImageFormat == swapchainInfo.swapchainImageFormat;
+		cleanupSwapChain(keepFrameGraph, submittedFrames);
+		swapchainInfo = replacement;
 
-		trianglePresentation::createSwapchain(physicalDevice, device, surface, window, swapchainInfo);
 		createImageViews();
-		createColorResources();
-		createDepthResources();
-		createFramebuffers();
-	}
-
-	void cleanupSwapChain(void)
-	{
-		vkDestroyImageView(device, depthImageView, nullptr);
-		vkDestroyImage(device, depthImage, nullptr);
-		vkFreeMemory(device, depthImageMemory, nullptr);
-		vkDestroyImageView(device, colorImageView, nullptr);
-		vkDestroyImage(device, colorImage, nullptr);
-		vkFreeMemory(device, colorImageMemory, nullptr);
-		for (auto fb : swapChainFramebuffers) {
-			vkDestroyFramebuffer(device, fb, nullptr);
-		}
-		for (auto imageView : swapChainImageViews) {
-			vkDestroyImageView(device, imageView, nullptr);
+		if (!keepFrameGraph)
+			buildFrameGraph();
+		if (!useDynamicRendering)
+			createFramebuffers();
+		if (useCommandCache) {
+			std::vector<VkCommandBuffer> cached;
+			cached.swap(cachedCommandBuffers);
+			frameDeletions.push(submittedFrames, [this, cached] {
+				vkFreeCommandBuffers(device, commandPool, static_cast<uint32_t>(cached.size()), cached.data());
+			});
+			invalidateCommandCache();
 		}
-		vkDestroySwapchainKHR(device, swapchainInfo.swapchain, nullptr);
 	}
 
-	void createVertexBuffers(void)
+	// queues the swapchain and everything built on it for destruction once the first submittedFrames frames are done.
+	// the handle stays valid until then, recreateSwapChain still passes it as oldSwapchain
+	void cleanupSwapChain(bool keepFrameGraph, uint64_t submittedFrames)
 	{
-		VkDeviceSize bufferSize = sizeof(vertices[0]) * vertices.size();
-
-		VkBuffer stagingBuffer;
-		VkDeviceMemory stagingBufferMemory;
-		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			     stagingBuffer, stagingBufferMemory);
-
-		void *data;
-		vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, vertices.data(), (size_t)bufferSize);
-		vkUnmapMemory(device, stagingBufferMemory);
-
-		createBuffer(bufferSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			     vertexBuffer, vertexBufferMemory);
-
-		copyBuffer(stagingBuffer, vertexBuffer, bufferSize);
-
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+		if (!keepFrameGraph) {
+			auto graph = std::make_shared<tgraph::RenderGraph>();
+			std::swap(*graph, frameGraph);
+			frameDeletions.push(submittedFrames, [this, graph] { graph->destroy(device); });
+		}
+		std::vector<VkFramebuffer> framebuffers;
+		framebuffers.swap(swapChainFramebuffers);
+		std::vector<VkImageView> imageViews;
+		imageViews.swap(swapChainImageViews);
+		VkSwapchainKHR swapchain = swapchainInfo.swapchain;
+		frameDeletions.push(submittedFrames, [this, framebuffers, imageViews, swapchain] {
+			for (auto fb : framebuffers) {
+				vkDestroyFramebuffer(device, fb, nullptr);
+			}
+			for (auto imageView : imageViews) {
+				vkDestroyImageView(device, imageView, nullptr);
+			}
+			vkDestroySwapchainKHR(device, swapchain, nullptr);
+		});
 	}
 
-	void createIndexBuffers(void)
+	// uploads data through a staging buffer into a new device local buffer
+	void createDeviceLocalBuffer(const void *contents, VkDeviceSize bufferSize, VkBufferUsageFlags usage, VkBuffer &buffer, VkDeviceMemory &bufferMemory)
 	{
-		VkDeviceSize bufferSize = sizeof(indices[0]) * indices.size();
-
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
 		createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 			     stagingBuffer, stagingBufferMemory);
+		DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, stagingBuffer, "staging buffer");
 
 		void *data;
 		vkMapMemory(device, stagingBufferMemory, 0, bufferSize, 0, &data);
-		memcpy(data, indices.data(), (size_t)bufferSize);
+		memcpy(data, contents, (size_t)bufferSize);
 		vkUnmapMemory(device, stagingBufferMemory);
 
-		createBuffer(bufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, indexBuffer,
-			     indexBufferMemory);
+		createBuffer(bufferSize, usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
 
-		copyBuffer(stagingBuffer, indexBuffer, bufferSize);
+		copyBuffer(stagingBuffer, buffer, bufferSize);
 
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+		releaseStagingBuffer(stagingBuffer, stagingBufferMemory);
 	}
 
 	void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands("buffer upload");
 
 		VkBufferCopy copyRegion{};
 		copyRegion.srcOffset = 0;
@@ -854,7 +1771,7 @@ class TriangleApp
 		bufferInfo.size = size;
 		bufferInfo.usage = usage;
 		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateBuffer", vkCreateBuffer, device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create vertex buffer");
 		}
 
@@ -866,7 +1783,7 @@ class TriangleApp
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
-		if (vkAllocateMemory(device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+		if (tprofile::timed("vkAllocateMemory", vkAllocateMemory, device, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to allocate vertex buffer memory");
 		}
 		vkBindBufferMemory(device, buffer, bufferMemory, 0);
@@ -885,45 +1802,184 @@ class TriangleApp
 		samplerLayoutBinding.binding = 1;
 		samplerLayoutBinding.descriptorCount = 1;
 		samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		samplerLayoutBinding.pImmutableSamplers = nullptr;
+		// immutable: the sampler is part of the layout so descriptor writes only carry the image view
+		samplerLayoutBinding.pImmutableSamplers = &textureSampler;
 		samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
 
-		std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
+		VkDescriptorSetLayoutBinding objectLayoutBinding{};
+		objectLayoutBinding.binding = 2;
+		objectLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		objectLayoutBinding.descriptorCount = 1;
+		objectLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+		objectLayoutBinding.pImmutableSamplers = nullptr;
+
+		// with bindless the texture lives in set 1 instead
+		std::vector<VkDescriptorSetLayoutBinding> bindings = {uboLayoutBinding, objectLayoutBinding};
+		if (!useBindless)
+			bindings.push_back(samplerLayoutBinding);
 
 		VkDescriptorSetLayoutCreateInfo layoutInfo{};
 		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
 		layoutInfo.pBindings = bindings.data();
 
-		if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateDescriptorSetLayout", vkCreateDescriptorSetLayout, device, &layoutInfo, nullptr, &descriptorSetLayout) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create descriptor set layout");
 		}
+
+		if (useBindless)
+			createBindlessSetLayout();
 	}
 
-	void createUniformBuffers(void)
+	void chooseBindlessMode(void)
+	{
+		switch (tsettings::settings.bindless) {
+		case tsettings::bindlessMode::automatic:
+			useBindless = deviceCapabilities.descriptorIndexing;
+			break;
+		case tsettings::bindlessMode::on:
+			if (!deviceCapabilities.descriptorIndexing)
+				throw std::runtime_error("Device does not support descriptor indexing, cant do bindless textures");
+			useBindless = true;
+			break;
+		case tsettings::bindlessMode::off:
+			useBindless = false;
+			break;
+		}
+		if (useBindless)
+			bindlessTextureCapacity = std::min(MAX_BINDLESS_TEXTURES, deviceCapabilities.maxBindlessTextures);
+	}
+
+	void createBindlessSetLayout(void)
+	{
+		std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+		bindings[0].binding = 0;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+		bindings[0].descriptorCount = 1;
+		bindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		bindings[0].pImmutableSamplers = &textureSampler;
+		bindings[1].binding = 1;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		bindings[1].descriptorCount = bindlessTextureCapacity;
+		bindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+
+		// partially bound: unused slots can stay empty. update after bind + unused while pending: new textures can be
+		// written into free slots while frames that use the set are still in flight
+		std::array<VkDescriptorBindingFlagsEXT, 2> bindingFlags = {
+		    0, VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT_EXT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT_EXT |
+			   VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT_EXT};
+		VkDescriptorSetLayoutBindingFlagsCreateInfoEXT bindingFlagsInfo{};
+		bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO_EXT;
+		bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+		bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.pNext = &bindingFlagsInfo;
+		layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT_EXT;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+
+		if (tprofile::timed("vkCreateDescriptorSetLayout", vkCreateDescriptorSetLayout, device, &layoutInfo, nullptr, &bindlessSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create bindless descriptor set layout");
+		}
+	}
+
+	void createBindlessDescriptorSet(void)
 	{
-		VkDeviceSize bufferSize = sizeof(UniformBufferObject);
-		uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-		uniformBuffersMemory.resize(MAX_FRAMES_IN_FLIGHT);
-		uniformBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_SAMPLER;
+		poolSizes[0].descriptorCount = 1;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		poolSizes[1].descriptorCount = bindlessTextureCapacity;
+
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT_EXT;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = 1;
+		if (tprofile::timed("vkCreateDescriptorPool", vkCreateDescriptorPool, device, &poolInfo, nullptr, &bindlessDescriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create bindless descriptor pool");
+		}
 
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+		VkDescriptorSetAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocInfo.descriptorPool = bindlessDescriptorPool;
+		allocInfo.descriptorSetCount = 1;
+		allocInfo.pSetLayouts = &bindlessSetLayout;
+		if (vkAllocateDescriptorSets(device, &allocInfo, &bindlessDescriptorSet) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate bindless descriptor set");
+		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_DESCRIPTOR_SET, bindlessDescriptorSet, "bindless textures");
+		// nothing to write for the sampler binding, its immutable
+	}
+
+	// puts a texture in the next free slot of the bindless array and returns its index for DrawPushConstants
+	uint32_t registerBindlessTexture(VkImageView imageView)
+	{
+		if (bindlessTextureCount >= bindlessTextureCapacity) {
+			throw std::runtime_error("bindless texture array is full");
+		}
+		uint32_t index = bindlessTextureCount++;
+
+		VkDescriptorImageInfo imageInfo{};
+		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		imageInfo.imageView = imageView;
+		VkWriteDescriptorSet descriptorWrite{};
+		descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		descriptorWrite.dstSet = bindlessDescriptorSet;
+		descriptorWrite.dstBinding = 1;
+		descriptorWrite.dstArrayElement = index;
+		descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+		descriptorWrite.descriptorCount = 1;
+		descriptorWrite.pImageInfo = &imageInfo;
+		vkUpdateDescriptorSets(device, 1, &descriptorWrite, 0, nullptr);
+		return index;
+	}
+
+	void createUniformBuffers(void)
+	{
+		VkDeviceSize bufferSize = sizeof(CameraUniforms);
+		uniformBuffers.resize(framesInFlight);
+		uniformBuffersMemory.resize(framesInFlight);
+		uniformBuffersMapped.resize(framesInFlight);
+
+		// dynamic offsets have to be multiples of minUniformBufferOffsetAlignment (a power of two)
+		VkDeviceSize alignment = deviceCapabilities.properties.limits.minUniformBufferOffsetAlignment;
+		objectUniformStride = (sizeof(ObjectUniforms) + alignment - 1) & ~(alignment - 1);
+		// push transforms never read the ring, one slot is just there so the binding 2 descriptor stays valid
+		bool dynamicTransforms = tsettings::settings.transforms == tsettings::transformMode::dynamic;
+		VkDeviceSize objectBufferSize = objectUniformStride * (dynamicTransforms ? tsettings::settings.drawCount : 1);
+		objectUniformBuffers.resize(framesInFlight);
+		objectUniformBuffersMemory.resize(framesInFlight);
+		objectUniformBuffersMapped.resize(framesInFlight);
+		drawTransforms.resize(tsettings::settings.drawCount);
+
+		for (size_t i = 0; i < framesInFlight; ++i) {
 			createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 				     uniformBuffers[i], uniformBuffersMemory[i]);
 
 			vkMapMemory(device, uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
+
+			createBuffer(objectBufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+				     VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, objectUniformBuffers[i],
+				     objectUniformBuffersMemory[i]);
+			vkMapMemory(device, objectUniformBuffersMemory[i], 0, objectBufferSize, 0, &objectUniformBuffersMapped[i]);
+			DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, uniformBuffers[i], "frame " + std::to_string(i) + " camera uniforms");
+			DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, objectUniformBuffers[i], "frame " + std::to_string(i) + " object uniforms");
 		}
 	}
 
 	void updateUniformBuffer(uint32_t currentImage)
 	{
+		TRACE_ZONE("updateUniformBuffer");
 		static auto startTime = std::chrono::high_resolution_clock::now();
 		auto currentTime = std::chrono::high_resolution_clock::now();
 
 		float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
 
-		UniformBufferObject ubo{};
-		ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		CameraUniforms ubo{};
 		ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 		ubo.proj =
 		    glm::perspective(glm::radians(45.0f), swapchainInfo.swapchainExtent.width / (float)swapchainInfo.swapchainExtent.height, 0.1f, 10.0f);
@@ -937,56 +1993,268 @@ class TriangleApp
 		/*
 		Using a UBO this way is not the most efficient way to pass frequently changing values to the shader. A more efficient way to pass a small buffer
 		of data to shaders are push constants. We may look at these in a future chapter.*/
+		// only the camera goes through this ubo now, per draw model matrices are push constants or come out of the dynamic offset ring
 		memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
+
+		// all copies spin the same way, laid out on a grid that always fits the original model's footprint
+		glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+		uint32_t drawCount = static_cast<uint32_t>(drawTransforms.size());
+		uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<float>(drawCount))));
+		float scale = 1.0f / static_cast<float>(gridSize);
+		bool dynamicTransforms = tsettings::settings.transforms == tsettings::transformMode::dynamic;
+		uint8_t *ring = static_cast<uint8_t *>(objectUniformBuffersMapped[currentImage]);
+		jobs->parallelFor(drawCount, TRANSFORM_JOB_GRAIN, [&](uint32_t firstDraw, uint32_t endDraw) {
+			for (uint32_t draw = firstDraw; draw < endDraw; ++draw) {
+				glm::vec3 offset((draw % gridSize + 0.5f) * scale * 2.0f - 1.0f, (draw / gridSize + 0.5f) * scale * 2.0f - 1.0f, 0.0f);
+				glm::mat4 transform = glm::scale(glm::translate(glm::mat4(1.0f), offset), glm::vec3(scale)) * rotation;
+				drawTransforms[draw] = transform;
+				if (dynamicTransforms)
+					memcpy(ring + draw * objectUniformStride, &transform, sizeof(transform));
+			}
+		});
+	}
+
+	// prints the cpu time of updateUniformBuffer + recording (or picking the cached commands), scaled to 10k draws so
+	// --transforms and --cache-commands can be compared
+	void reportDrawCost(std::chrono::high_resolution_clock::duration elapsed)
+	{
+		if (!tsettings::settings.reportDrawCost)
+			return;
+		drawCostSeconds += std::chrono::duration<double>(elapsed).count();
+		if (++drawCostFrames < STATS_REPORT_INTERVAL)
+			return;
+		double perFrame = drawCostSeconds / drawCostFrames;
+		double per10k = perFrame * 10000.0 / tsettings::settings.drawCount;
+		// jobs only run inside the measured part of the frame, so thats what their busy time is compared against
+		double jobBusySeconds = 0.0;
+		for (uint32_t worker = 0; worker < jobs->size(); ++worker) {
+			jobBusySeconds += jobs->stats(worker).busySeconds;
+		}
+		jobs->resetStats();
+		std::cout << "transforms (" << (tsettings::settings.transforms == tsettings::transformMode::push ? "push" : "dynamic")
+			  << (useCommandCache ? ", cached commands" : "") << ", " << std::max(recordChunkCount, 1u) << " recording chunks, "
+			  << tsettings::settings.drawCount << " draws): " << perFrame * 1e3 << " ms cpu per frame, " << per10k * 1e3 << " ms per 10k draws, "
+			  << jobs->size() << " job workers " << jobBusySeconds / (drawCostSeconds * jobs->size()) * 100.0 << "% busy" << std::endl;
+		drawCostSeconds = 0.0;
+		drawCostFrames = 0;
+	}
+
+	// input sampled -> vkQueuePresentKHR returned, so how stale the input is by the time the frame is handed to presentation
+	void recordPresentLatency(void)
+	{
+		if (!tsettings::settings.reportLatency)
+			return;
+		auto now = std::chrono::high_resolution_clock::now();
+		if (presentLatencySamples > 0) {
+			double frameTime = std::chrono::duration<double>(now - lastPresentTime).count();
+			frameTimeSum += frameTime;
+			frameTimeSquaredSum += frameTime * frameTime;
+			++frameTimeSamples;
+		}
+		lastPresentTime = now;
+		double latency = std::chrono::duration<double>(now - frameInputTimes[currentFrame]).count();
+		presentLatencySum += latency;
+		presentLatencyMax = std::max(presentLatencyMax, latency);
+		frameRetirePending[currentFrame] = true;
+		if (++presentLatencySamples >= STATS_REPORT_INTERVAL)
+			reportLatency();
+	}
+
+	// input sampled -> the frames fence was seen signaled. the fence is only looked at when its slot comes around again
+	// so this is an upper bound, tight with --frames-in-flight=1
+	void recordRetireLatency(void)
+	{
+		if (!tsettings::settings.reportLatency || !frameRetirePending[currentFrame])
+			return;
+		double latency = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - frameInputTimes[currentFrame]).count();
+		retireLatencySum += latency;
+		retireLatencyMax = std::max(retireLatencyMax, latency);
+		++retireLatencySamples;
+		frameRetirePending[currentFrame] = false;
+	}
+
+	void reportGpuTime(void)
+	{
+		if (!tsettings::settings.reportGpuTime || ++gpuTimeFrames < STATS_REPORT_INTERVAL)
+			return;
+		gpuTimeFrames = 0;
+		if (!frameTimers.enabled()) {
+			std::cout << "gpu time: the graphics queue has no timestamps" << std::endl;
+			return;
+		}
+		std::cout << "gpu time, last " << tgputime::ROLLING_WINDOW << " samples of each:" << std::endl;
+		frameTimers.report(std::cout);
+		uploadTimers.report(std::cout);
+	}
+
+	// whatever was called since the last frame started is that frames count, uploads from other threads included
+	void countApiCalls(void)
+	{
+		if (!tsettings::settings.apiCounters)
+			return;
+		tapi::callCounts frame = tapi::take();
+		if (apiWarmupFrames > 0) {
+			--apiWarmupFrames;
+			return;
+		}
+		if (apiHavePrevious && frame != apiPreviousFrame) {
+			std::cout << "api counters changed before frame " << frameNumber << ": ";
+			tapi::print(std::cout, apiPreviousFrame, 1);
+			std::cout << std::endl << "  now ";
+			tapi::print(std::cout, frame, 1);
+			std::cout << std::endl;
+		}
+		apiPreviousFrame = frame;
+		apiHavePrevious = true;
+		uint32_t expectSubmits = tsettings::settings.expectSubmits;
+		uint32_t expectAllocations = tsettings::settings.expectAllocations;
+		if (expectSubmits != UINT32_MAX && frame.submits != expectSubmits) {
+			throw std::runtime_error("frame " + std::to_string(frameNumber) + " made " + std::to_string(frame.submits) + " submits, expected " +
+						 std::to_string(expectSubmits));
+		}
+		if (expectAllocations != UINT32_MAX && frame.allocations != expectAllocations) {
+			throw std::runtime_error("frame " + std::to_string(frameNumber) + " made " + std::to_string(frame.allocations) +
+						 " allocations, expected " + std::to_string(expectAllocations));
+		}
+
+		apiTotals.commands += frame.commands;
+		apiTotals.draws += frame.draws;
+		apiTotals.dispatches += frame.dispatches;
+		apiTotals.barriers += frame.barriers;
+		apiTotals.submits += frame.submits;
+		apiTotals.descriptorUpdates += frame.descriptorUpdates;
+		apiTotals.allocations += frame.allocations;
+		apiTotals.copyBytes += frame.copyBytes;
+		if (++apiFrames < STATS_REPORT_INTERVAL)
+			return;
+		std::cout << "api calls per frame: ";
+		tapi::print(std::cout, apiTotals, apiFrames);
+		std::cout << std::endl;
+		apiTotals = {};
+		apiFrames = 0;
+	}
+
+	bool analyzingStalls(void) { return !tsettings::settings.stallReportPath.empty(); }
+
+	void recordStall(tstall::wait kind, std::chrono::steady_clock::time_point since)
+	{
+		if (analyzingStalls())
+			stalls.addWait(kind, std::chrono::steady_clock::now() - since);
+	}
+
+	// per frame averages of the counters next to cpu and gpu frame time, to see what culling or lod actually saved
+	void reportPipelineStats(void)
+	{
+		if (!pipelineStats.enabled())
+			return;
+		auto now = std::chrono::high_resolution_clock::now();
+		if (pipelineStatsFrames++ == 0) {
+			pipelineStatsStart = now;
+			return;
+		}
+		if (pipelineStatsFrames <= STATS_REPORT_INTERVAL)
+			return;
+		double frameMs = std::chrono::duration<double, std::milli>(now - pipelineStatsStart).count() / (pipelineStatsFrames - 1);
+		pipelineStatsFrames = 0;
+		uint32_t frames;
+		tgputime::pipelineCounters totals = pipelineStats.takeTotals(frames);
+		if (frames == 0) {
+			std::cout << "pipeline stats: nothing counted, secondaries need inheritedQueries" << std::endl;
+			return;
+		}
+		std::cout << "pipeline stats (" << tsettings::settings.drawCount << " draws): " << frameMs << " ms frame time";
+		auto gpuTimes = frameTimers.stats();
+		auto gpuFrame = gpuTimes.find("frame");
+		if (gpuFrame != gpuTimes.end())
+			std::cout << ", " << gpuFrame->second.averageMs << " ms gpu";
+		// clipping can split a primitive into several, more can come out than went in so this bottoms out at 0
+		double clipped =
+		    totals.clippingInvocations > 0 ? std::max(0.0, 1.0 - static_cast<double>(totals.clippingPrimitives) / totals.clippingInvocations) : 0.0;
+		std::cout << ", per frame " << totals.vertexInvocations / frames << " vertex invocations, " << totals.clippingInvocations / frames
+			  << " primitives into clipping, " << totals.clippingPrimitives / frames << " out (" << clipped * 100.0 << "% clipped), "
+			  << totals.fragmentInvocations / frames << " fragment invocations" << std::endl;
+	}
+
+	void reportLatency(void)
+	{
+		std::cout << "latency (" << framesInFlight << " frames in flight, " << swapchainInfo.swapchainImages.size() << " swapchain images"
+			  << (tsettings::settings.lowLatency ? ", low latency" : "") << (useRenderThread ? ", render thread" : ", single thread");
+		if (tsettings::settings.eventLoadMicros > 0)
+			std::cout << ", " << tsettings::settings.eventLoadMicros << " us event load";
+		std::cout << "): input to present " << presentLatencySum / presentLatencySamples * 1e3 << " ms avg " << presentLatencyMax * 1e3 << " ms max";
+		if (retireLatencySamples > 0) {
+			std::cout << ", input to gpu done <= " << retireLatencySum / retireLatencySamples * 1e3 << " ms avg " << retireLatencyMax * 1e3
+				  << " ms max";
+		}
+		if (frameTimeSamples > 0) {
+			double mean = frameTimeSum / frameTimeSamples;
+			double jitter = std::sqrt(std::max(0.0, frameTimeSquaredSum / frameTimeSamples - mean * mean));
+			std::cout << ", frame time " << mean * 1e3 << " ms avg " << jitter * 1e3 << " ms jitter";
+		}
+		std::cout << std::endl;
+		presentLatencySum = presentLatencyMax = retireLatencySum = retireLatencyMax = 0.0;
+		presentLatencySamples = retireLatencySamples = 0;
+		frameTimeSum = frameTimeSquaredSum = 0.0;
+		frameTimeSamples = 0;
 	}
 
 	void createDescriptorPool(void)
 	{
-		std::array<VkDescriptorPoolSize, 2> poolSizes;
+		std::array<VkDescriptorPoolSize, 3> poolSizes;
 		poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
-		poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		poolSizes[0].descriptorCount = framesInFlight;
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		poolSizes[1].descriptorCount = framesInFlight;
+		poolSizes[2].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		poolSizes[2].descriptorCount = framesInFlight;
 
 		VkDescriptorPoolCreateInfo poolInfo{};
 		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.poolSizeCount = useBindless ? 2 : static_cast<uint32_t>(poolSizes.size());
 		poolInfo.pPoolSizes = poolSizes.data();
-		poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		poolInfo.maxSets = framesInFlight;
 		poolInfo.flags = 0; // optional, can be set to indicate that the sets can be freed during runtime
 
-		if (vkCreateDescriptorPool(device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateDescriptorPool", vkCreateDescriptorPool, device, &poolInfo, nullptr, &descriptorPool) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create descriptor pool");
 		}
 	}
 
 	void createDescriptorSets(void)
 	{
-		std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, descriptorSetLayout);
+		std::vector<VkDescriptorSetLayout> layouts(framesInFlight, descriptorSetLayout);
 		VkDescriptorSetAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 		allocInfo.descriptorPool = descriptorPool;
-		allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+		allocInfo.descriptorSetCount = framesInFlight;
 		allocInfo.pSetLayouts = layouts.data();
 
-		descriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+		descriptorSets.resize(framesInFlight);
 		if (vkAllocateDescriptorSets(device, &allocInfo, descriptorSets.data()) != VK_SUCCESS) {
 			throw std::runtime_error("failed to allocate descriptor sets!");
 		}
+		for (size_t i = 0; i < framesInFlight; ++i) {
+			DEBUG_NAME(device, VK_OBJECT_TYPE_DESCRIPTOR_SET, descriptorSets[i], "frame " + std::to_string(i) + " descriptors");
+		}
 		// will be automatically freeds when the pool is destroyed
 
-		for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+		for (size_t i = 0; i < framesInFlight; ++i) {
 			VkDescriptorBufferInfo bufferInfo{};
 			bufferInfo.buffer = uniformBuffers[i];
 			bufferInfo.offset = 0;
-			bufferInfo.range = sizeof(UniformBufferObject);
+			bufferInfo.range = sizeof(CameraUniforms);
+
+			VkDescriptorBufferInfo objectBufferInfo{};
+			objectBufferInfo.buffer = objectUniformBuffers[i];
+			objectBufferInfo.offset = 0;
+			objectBufferInfo.range = sizeof(ObjectUniforms);
 
 			VkDescriptorImageInfo imageInfo{};
 			imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			imageInfo.imageView = textureImageView;
-			imageInfo.sampler = textureSampler;
+			imageInfo.imageView = texture->view;
+			// sampler is immutable in the layout, whatever is written here gets ignored
 
-			std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+			std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
 			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 			descriptorWrites[0].dstSet = descriptorSets[i];
 			descriptorWrites[0].dstBinding = 0;
@@ -997,58 +2265,150 @@ class TriangleApp
 
 			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 			descriptorWrites[1].dstSet = descriptorSets[i];
-			descriptorWrites[1].dstBinding = 1;
+			descriptorWrites[1].dstBinding = 2;
 			descriptorWrites[1].dstArrayElement = 0;
-			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 			descriptorWrites[1].descriptorCount = 1;
-			descriptorWrites[1].pImageInfo = &imageInfo;
-
-			vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+			descriptorWrites[1].pBufferInfo = &objectBufferInfo;
+
+			descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[2].dstSet = descriptorSets[i];
+			descriptorWrites[2].dstBinding = 1;
+			descriptorWrites[2].dstArrayElement = 0;
+			descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			descriptorWrites[2].descriptorCount = 1;
+			descriptorWrites[2].pImageInfo = &imageInfo;
+
+			// bindless sets only have the buffers, the texture goes through registerBindlessTexture
+			uint32_t writeCount = useBindless ? 2 : static_cast<uint32_t>(descriptorWrites.size());
+			vkUpdateDescriptorSets(device, writeCount, descriptorWrites.data(), 0, nullptr);
 		}
 	}
 
-	void createTextureImage(void)
+	// decodes and uploads the image at path unless a texture with the same file contents is already loaded, either way the
+	// caller holds one reference to the result and gives it back with releaseTexture(key)
+	const TextureAsset *loadTexture(const std::string &path, tasset::assetKey &key)
+	{
+		std::vector<uint8_t> bytes = tasset::readFile(path);
+		key = tasset::hash64(bytes.data(), bytes.size());
+		if (const TextureAsset *existing = textureAssets.acquire(key))
+			return existing;
+		return uploadTexture(decodeTexture(bytes, key));
+	}
+
+	DecodedTexture decodeTexture(const std::vector<uint8_t> &bytes, tasset::assetKey key)
 	{
-		int texWidth;
-		int texHeight;
+		tprofile::Scope scope("decodeTexture", tprofile::kind::stage);
+		TRACE_ZONE("decodeTexture");
+		DecodedTexture decoded{};
+		decoded.key = key;
 		int texChannels;
-		stbi_uc *pixels = stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-		if (!pixels) {
+		int byteCount = static_cast<int>(bytes.size());
+		if (!stbi_info_from_memory(bytes.data(), byteCount, &decoded.width, &decoded.height, &texChannels)) {
 			throw std::runtime_error("failed to load texture image data");
 		}
-		VkDeviceSize imageSize = texWidth * texHeight * 4;
-		mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+		// let stb keep rgb as rgb, the expansion to rgba happens straight into the staging buffer in uploadTexture
+		decoded.hasAlpha = texChannels == 2 || texChannels == 4;
+		decoded.pixels = stbi_load_from_memory(bytes.data(), byteCount, &decoded.width, &decoded.height, &texChannels,
+						       decoded.hasAlpha ? STBI_rgb_alpha : STBI_rgb);
+		if (!decoded.pixels) {
+			throw std::runtime_error("failed to load texture image data");
+		}
+		return decoded;
+	}
+
+	// adds a decoded texture to the registry with one reference, same as a loadTexture miss
+	const TextureAsset *uploadTexture(const DecodedTexture &decoded)
+	{
+		tprofile::Scope scope("uploadTexture", tprofile::kind::stage);
+		TRACE_ZONE("uploadTexture");
+		int texWidth = decoded.width;
+		int texHeight = decoded.height;
+		bool hasAlpha = decoded.hasAlpha;
+		stbi_uc *pixels = decoded.pixels;
+		size_t pixelCount = static_cast<size_t>(texWidth) * static_cast<size_t>(texHeight);
+		VkDeviceSize imageSize = pixelCount * 4;
+		TextureAsset asset{};
+		asset.mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 
 		VkBuffer stagingBuffer;
 		VkDeviceMemory stagingBufferMemory;
 
 		createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
 			     stagingBuffer, stagingBufferMemory);
+		DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, stagingBuffer, "texture staging buffer");
 
 		void *data;
 		vkMapMemory(device, stagingBufferMemory, 0, imageSize, 0, &data);
-		memcpy(data, pixels, static_cast<size_t>(imageSize));
+		if (hasAlpha) {
+			memcpy(data, pixels, static_cast<size_t>(imageSize));
+		} else {
+			// every job writes its own range of the staging buffer, still in order within it
+			uint8_t *staging = static_cast<uint8_t *>(data);
+			uint32_t chunkCount = static_cast<uint32_t>((pixelCount + PIXEL_JOB_GRAIN - 1) / PIXEL_JOB_GRAIN);
+			jobs->parallelFor(chunkCount, 1, [&](uint32_t firstChunk, uint32_t endChunk) {
+				size_t first = static_cast<size_t>(firstChunk) * PIXEL_JOB_GRAIN;
+				size_t end = std::min(pixelCount, static_cast<size_t>(endChunk) * PIXEL_JOB_GRAIN);
+				tpixel::expandRGBToRGBA(staging + first * 4, pixels + first * 3, end - first);
+			});
+		}
 		vkUnmapMemory(device, stagingBufferMemory);
 		stbi_image_free(pixels);
 
-		createImage(texWidth, texHeight, mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-			    VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			    textureImage, textureImageMemory);
+		if (useComputeMipGen) {
+			// srgb formats usually cant be storage images, so the image is unorm and only the view we sample from is srgb
+			createImage(texWidth, texHeight, asset.mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_TILING_OPTIMAL,
+				    VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				    asset.image, asset.memory, VK_IMAGE_CREATE_MUTABLE_FORMAT_BIT);
+		} else {
+			createImage(texWidth, texHeight, asset.mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+				    VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+				    asset.image, asset.memory);
+		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE, asset.image, assetName("texture", decoded.key));
 
-		transitionImageLayout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
-		copyBufferToImage(stagingBuffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+		transitionImageLayout(asset.image, VK_IMAGE_ASPECT_COLOR_BIT, tgraph::access::none, tgraph::access::transferWrite, asset.mipLevels);
+		copyBufferToImage(stagingBuffer, asset.image, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
 		// transition to shader read optimal format handled in generate mip mapa
-		generateMipMaps(textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
+		generateMipMaps(asset.image, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, asset.mipLevels);
+
+		releaseStagingBuffer(stagingBuffer, stagingBufferMemory);
+
+		// the compute path made the image with storage usage, which the srgb format usually doesnt support. the view
+		// is only ever sampled, so it only asks for that. the blit image is srgb already and needs nothing extra
+		asset.view = createImageView(asset.image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, asset.mipLevels, 0,
+					     useComputeMipGen ? VK_IMAGE_USAGE_SAMPLED_BIT : 0);
+		DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE_VIEW, asset.view, assetName("texture", decoded.key));
+		return textureAssets.insert(decoded.key, asset);
+	}
+
+	// what shows up for an asset in capture tools, the key is all that identifies it after loading
+	std::string assetName(const char *kind, tasset::assetKey key) const
+	{
+		std::ostringstream name;
+		name << kind << " " << std::hex << key;
+		return name.str();
+	}
 
-		vkDestroyBuffer(device, stagingBuffer, nullptr);
-		vkFreeMemory(device, stagingBufferMemory, nullptr);
+	void releaseTexture(tasset::assetKey key)
+	{
+		TextureAsset released;
+		if (!textureAssets.release(key, released))
+			return;
+		// frames in flight may still sample it, swapping a texture out doesnt have to wait for them
+		frameDeletions.push(frameNumber, [this, released] {
+			vkDestroyImageView(device, released.view, nullptr);
+			vkDestroyImage(device, released.image, nullptr);
+			vkFreeMemory(device, released.memory, nullptr);
+		});
 	}
 
 	void createImage(uint32_t width, uint32_t height, uint32_t mipLevels, VkSampleCountFlagBits numSamples, VkFormat format, VkImageTiling tiling, VkImageUsageFlags usage,
-			 VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory)
+			 VkMemoryPropertyFlags properties, VkImage &image, VkDeviceMemory &imageMemory, VkImageCreateFlags flags = 0)
 	{
 		VkImageCreateInfo imageInfo{};
 		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.flags = flags;
 		imageInfo.imageType = VK_IMAGE_TYPE_2D;
 		imageInfo.extent.width = width;
 		imageInfo.extent.height = height;
@@ -1062,7 +2422,7 @@ class TriangleApp
 		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		imageInfo.samples = numSamples;
 
-		if (vkCreateImage(device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateImage", vkCreateImage, device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create vk image for texture");
 		}
 
@@ -1073,14 +2433,15 @@ class TriangleApp
 		allocInfo.allocationSize = memRequirements.size;
 		allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
-		if (vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
+		if (tprofile::timed("vkAllocateMemory", vkAllocateMemory, device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to allocate memory for image");
 		}
 
 		vkBindImageMemory(device, image, imageMemory, 0);
 	}
 
-	VkCommandBuffer beginSingleTimeCommands(void)
+	// a named upload gets timed on the gpu if a timer slot is free
+	VkCommandBuffer beginSingleTimeCommands(const char *timerName = nullptr)
 	{
 		VkCommandBufferAllocateInfo allocInfo{};
 		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -1090,17 +2451,33 @@ class TriangleApp
 
 		VkCommandBuffer commandBuffer;
 		vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer);
+		DEBUG_NAME(device, VK_OBJECT_TYPE_COMMAND_BUFFER, commandBuffer, timerName ? timerName : "one time commands");
 
 		VkCommandBufferBeginInfo beginInfo{};
 		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
 		vkBeginCommandBuffer(commandBuffer, &beginInfo);
 
+		uint32_t timerSlot = timerName ? uploadTimers.idleSlot() : UINT32_MAX;
+		if (timerSlot != UINT32_MAX) {
+			uploadTimers.beginSlot(commandBuffer, timerSlot);
+			timedUploads[commandBuffer] = {timerSlot, uploadTimers.begin(commandBuffer, timerSlot, timerName)};
+		}
 		return commandBuffer;
 	}
 
-	void endSingleTimeCommands(VkCommandBuffer commandBuffer)
+	// returns the transfer timeline value the upload signals, 0 when there are no timelines and the upload is already done.
+	// uploads are submitted in order on one queue, so barriers in later uploads still cover earlier ones
+	uint64_t endSingleTimeCommands(VkCommandBuffer commandBuffer)
 	{
+		TRACE_ZONE("submit upload");
+		auto timed = timedUploads.find(commandBuffer);
+		uint32_t timerSlot = UINT32_MAX;
+		if (timed != timedUploads.end()) {
+			timerSlot = timed->second.first;
+			uploadTimers.end(commandBuffer, timerSlot, timed->second.second);
+			timedUploads.erase(timed);
+		}
 		vkEndCommandBuffer(commandBuffer);
 
 		VkSubmitInfo submitInfo{};
@@ -1108,65 +2485,78 @@ class TriangleApp
 		submitInfo.commandBufferCount = 1;
 		submitInfo.pCommandBuffers = &commandBuffer;
 
-		vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-		vkQueueWaitIdle(graphicsQueue);
+		if (!useTimeline) {
+			vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+			{
+				tprofile::Scope scope("wait for transfer", tprofile::kind::gpuWait);
+				TRACE_ZONE("wait for transfer");
+				vkQueueWaitIdle(graphicsQueue);
+			}
+			vkFreeCommandBuffers(device, memoryTransferCommandPool, 1, &commandBuffer);
+			if (timerSlot != UINT32_MAX) {
+				uploadTimers.submitted(timerSlot);
+				uploadTimers.collect(device, timerSlot);
+			}
+			return 0;
+		}
 
-		vkFreeCommandBuffers(device, memoryTransferCommandPool, 1, &commandBuffer);
+		uint64_t value = transferTimeline.reserve();
+		VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+		timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+		timelineInfo.signalSemaphoreValueCount = 1;
+		timelineInfo.pSignalSemaphoreValues = &value;
+		VkSemaphore signalSemaphore = transferTimeline.handle();
+		submitInfo.pNext = &timelineInfo;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &signalSemaphore;
+		if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit upload command buffer");
+		}
+		uploadDeletions.push(value, [this, commandBuffer] { vkFreeCommandBuffers(device, memoryTransferCommandPool, 1, &commandBuffer); });
+		if (timerSlot != UINT32_MAX) {
+			uploadTimers.submitted(timerSlot);
+			uploadDeletions.push(value, [this, timerSlot] { uploadTimers.collect(device, timerSlot); });
+		}
+		return value;
 	}
 
-	void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels)
+	// blocks until the upload that returned value is done, for when the cpu has to read or free something it used
+	void waitForTransfer(uint64_t value)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		tprofile::Scope scope("wait for transfer", tprofile::kind::gpuWait);
+		TRACE_ZONE("wait for transfer");
+		if (useTimeline)
+			transferTimeline.wait(device, value);
+	}
 
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.oldLayout = oldLayout;
-		barrier.newLayout = newLayout;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.image = image;
-		if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-			if (hasStencilComponent(format)) {
-				barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-			}
-		} else {
-			barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		}
-		barrier.subresourceRange.baseMipLevel = 0;
-		barrier.subresourceRange.levelCount = mipLevels;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
-
-		VkPipelineStageFlags sourceStage;
-		VkPipelineStageFlags destinationStage;
-		if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-			barrier.srcAccessMask = 0;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-		} else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-			destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		} else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-			barrier.srcAccessMask = 0;
-			barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-			destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-		} else {
-			throw std::invalid_argument("unsupported layout transition");
-		}
+	// frees a staging buffer once every upload submitted so far is done, right away without timelines
+	void releaseStagingBuffer(VkBuffer buffer, VkDeviceMemory memory)
+	{
+		uploadDeletions.push(transferTimeline.lastSignalValue(), [this, buffer, memory] {
+			vkDestroyBuffer(device, buffer, nullptr);
+			vkFreeMemory(device, memory, nullptr);
+		});
+		if (!useTimeline)
+			collectFinishedUploads();
+	}
 
-		vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+	// without timelines every upload was waited for when it got submitted
+	void collectFinishedUploads(void)
+	{
+		TRACE_ZONE("collectFinishedUploads");
+		uploadDeletions.flush(useTimeline ? transferTimeline.completedValue(device) : UINT64_MAX);
+	}
 
+	void transitionImageLayout(VkImage image, VkImageAspectFlags aspect, tgraph::access previous, tgraph::access next, uint32_t mipLevels)
+	{
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		tgraph::imageBarrier(commandBuffer, image, {aspect, 0, mipLevels, 0, 1}, previous, next);
 		endSingleTimeCommands(commandBuffer);
 	}
 
 	void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height)
 	{
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands("texture upload");
 
 		VkBufferImageCopy region{};
 		region.bufferOffset = 0;
@@ -1183,12 +2573,17 @@ class TriangleApp
 		endSingleTimeCommands(commandBuffer);
 	}
 
-	void createTextureImageView(void) { textureImageView = createImageView(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1); }
-
-	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels)
+	// usage 0 means the view gets every usage of the image, otherwise only these. needs deviceCapabilities.imageViewUsage
+	VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels, uint32_t baseMipLevel = 0,
+				    VkImageUsageFlags usage = 0)
 	{
 		VkImageViewCreateInfo createInfo{};
 		createInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		VkImageViewUsageCreateInfo usageInfo{};
+		usageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_USAGE_CREATE_INFO;
+		usageInfo.usage = usage;
+		if (usage != 0)
+			createInfo.pNext = &usageInfo;
 		createInfo.image = image;
 		createInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
 		createInfo.format = format;
@@ -1197,12 +2592,12 @@ class TriangleApp
 		createInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
 		createInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY;
 		createInfo.subresourceRange.aspectMask = aspectFlags;
-		createInfo.subresourceRange.baseMipLevel = 0;
+		createInfo.subresourceRange.baseMipLevel = baseMipLevel;
 		createInfo.subresourceRange.levelCount = mipLevels;
 		createInfo.subresourceRange.baseArrayLayer = 0;
 		createInfo.subresourceRange.layerCount = 1;
 		VkImageView imageView;
-		if (vkCreateImageView(device, &createInfo, nullptr, &imageView) != VK_SUCCESS) {
+		if (tprofile::timed("vkCreateImageView", vkCreateImageView, device, &createInfo, nullptr, &imageView) != VK_SUCCESS) {
 			throw std::runtime_error("Failed to create an image view");
 		}
 		return imageView;
@@ -1218,9 +2613,7 @@ class TriangleApp
 		samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 		samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
 		samplerInfo.anisotropyEnable = VK_TRUE;
-		VkPhysicalDeviceProperties properties{};
-		vkGetPhysicalDeviceProperties(physicalDevice, &properties);
-		samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy / 2;
+		samplerInfo.maxAnisotropy = deviceCapabilities.properties.limits.maxSamplerAnisotropy / 2;
 		samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
 		samplerInfo.unnormalizedCoordinates = VK_FALSE;
 		samplerInfo.compareEnable = VK_FALSE;
@@ -1228,22 +2621,10 @@ class TriangleApp
 		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
 		samplerInfo.mipLodBias = 0.0f;
 		samplerInfo.minLod = 0.0f;
-		samplerInfo.maxLod = static_cast<float>(mipLevels);
-
-		if (vkCreateSampler(device, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
-			throw std::runtime_error("Failed to create texture sampler");
-		}
-	}
-
-	void createDepthResources(void)
-	{
-		VkFormat depthFormat = findDepthFormat();
-		createImage(swapchainInfo.swapchainExtent.width, swapchainInfo.swapchainExtent.height, 1, msaaSamples, depthFormat, VK_IMAGE_TILING_OPTIMAL,
-			    VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, depthImage, depthImageMemory);
+		// no per texture mip count in here, the view already limits the levels and this way every texture can share one sampler
+		samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
 
-		depthImageView = createImageView(depthImage, depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
-		// optional transition but good to do for learning (its optional cuz the tutorial does it in the render pass anyway)
-		transitionImageLayout(depthImage, depthFormat, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, 1);
+		textureSampler = samplerCache.get(device, samplerInfo);
 	}
 
 	VkFormat findSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features)
@@ -1271,17 +2652,35 @@ class TriangleApp
 
 	bool hasStencilComponent(VkFormat format) { return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT; }
 
-	void loadModel(void)
+	// same deal as loadTexture, identical obj files are parsed and uploaded once
+	const MeshAsset *loadModel(const std::string &path, tasset::assetKey &key)
+	{
+		std::vector<uint8_t> bytes = tasset::readFile(path);
+		key = tasset::hash64(bytes.data(), bytes.size());
+		if (const MeshAsset *existing = meshAssets.acquire(key))
+			return existing;
+		return uploadModel(decodeModel(bytes, key));
+	}
+
+	DecodedMesh decodeModel(const std::vector<uint8_t> &bytes, tasset::assetKey key)
 	{
+		tprofile::Scope scope("decodeModel", tprofile::kind::stage);
+		TRACE_ZONE("decodeModel");
 		tinyobj::attrib_t attrib;
 		std::vector<tinyobj::shape_t> shapes;
 		std::vector<tinyobj::material_t> materials;
 		std::string warn, err;
 
-		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, MODEL_PATH.c_str())) {
+		std::istringstream objStream(std::string(bytes.begin(), bytes.end()));
+		tinyobj::MaterialFileReader materialReader("");
+		if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &objStream, &materialReader)) {
 			throw std::runtime_error(warn + err);
 		}
 
+		DecodedMesh decoded;
+		decoded.key = key;
+		std::vector<Vertex> &vertices = decoded.vertices;
+		std::vector<uint32_t> &indices = decoded.indices;
 		std::unordered_map<Vertex, uint32_t> uniqueVertices = {};
 		for (const auto &shape : shapes) {
 			for (const auto &index : shape.mesh.indices) {
@@ -1310,9 +2709,320 @@ class TriangleApp
 				indices.push_back(uniqueVertices[vertex]);
 			}
 		}
+		return decoded;
+	}
+
+	// adds a decoded mesh to the registry with one reference, same as a loadModel miss
+	const MeshAsset *uploadModel(const DecodedMesh &decoded)
+	{
+		tprofile::Scope scope("uploadModel", tprofile::kind::stage);
+		TRACE_ZONE("uploadModel");
+		const std::vector<Vertex> &vertices = decoded.vertices;
+		const std::vector<uint32_t> &indices = decoded.indices;
+		MeshAsset asset{};
+		createDeviceLocalBuffer(vertices.data(), sizeof(vertices[0]) * vertices.size(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, asset.vertexBuffer,
+					asset.vertexBufferMemory);
+		createDeviceLocalBuffer(indices.data(), sizeof(indices[0]) * indices.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, asset.indexBuffer,
+					asset.indexBufferMemory);
+		asset.indexCount = static_cast<uint32_t>(indices.size());
+		DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, asset.vertexBuffer, assetName("vertices", decoded.key));
+		DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, asset.indexBuffer, assetName("indices", decoded.key));
+		return meshAssets.insert(decoded.key, asset);
+	}
+
+	void releaseModel(tasset::assetKey key)
+	{
+		MeshAsset released;
+		if (!meshAssets.release(key, released))
+			return;
+		frameDeletions.push(frameNumber, [this, released] {
+			vkDestroyBuffer(device, released.indexBuffer, nullptr);
+			vkFreeMemory(device, released.indexBufferMemory, nullptr);
+			vkDestroyBuffer(device, released.vertexBuffer, nullptr);
+			vkFreeMemory(device, released.vertexBufferMemory, nullptr);
+		});
+	}
+
+	void chooseMipGenMode(void)
+	{
+		tprofile::Scope scope("chooseMipGenMode", tprofile::kind::stage);
+		VkFormatProperties srgbProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_SRGB, &srgbProperties);
+		bool blitSupported = srgbProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+		VkFormatProperties unormProperties;
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, VK_FORMAT_R8G8B8A8_UNORM, &unormProperties);
+		// the srgb view of the storage image can only drop the storage usage with VkImageViewUsageCreateInfo
+		bool computeSupported = deviceCapabilities.storageImageArrayDynamicIndexing && deviceCapabilities.imageViewUsage &&
+					(unormProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+
+		switch (tsettings::settings.mipGen) {
+		case tsettings::mipGenMode::automatic:
+			if (!computeSupported && !blitSupported)
+				throw std::runtime_error("Device can neither blit nor compute mip maps for the texture format");
+			useComputeMipGen = computeSupported;
+			break;
+		case tsettings::mipGenMode::blit:
+			if (!blitSupported)
+				throw std::runtime_error("texture image format does not support linear blitting");
+			useComputeMipGen = false;
+			break;
+		case tsettings::mipGenMode::compute:
+			if (!computeSupported)
+				throw std::runtime_error("Device does not support compute mip generation");
+			useComputeMipGen = true;
+			break;
+		}
+
+		if (useComputeMipGen)
+			createMipGenPipeline();
+	}
+
+	void createMipGenPipeline(void)
+	{
+		std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+		bindings[0].binding = 0;
+		bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		bindings[0].descriptorCount = 1;
+		bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		bindings[1].binding = 1;
+		bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		bindings[1].descriptorCount = MIPGEN_MAX_MIPS_PER_DISPATCH;
+		bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		bindings[2].binding = 2;
+		bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[2].descriptorCount = 1;
+		bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+		VkDescriptorSetLayoutCreateInfo layoutInfo{};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+		layoutInfo.pBindings = bindings.data();
+		if (tprofile::timed("vkCreateDescriptorSetLayout", vkCreateDescriptorSetLayout, device, &layoutInfo, nullptr, &mipGenDescriptorSetLayout) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create mip generation descriptor set layout");
+		}
+
+		VkPushConstantRange pushConstantRange{};
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = sizeof(MipGenPushConstants);
+
+		VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+		pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		pipelineLayoutCreateInfo.setLayoutCount = 1;
+		pipelineLayoutCreateInfo.pSetLayouts = &mipGenDescriptorSetLayout;
+		pipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		pipelineLayoutCreateInfo.pPushConstantRanges = &pushConstantRange;
+		if (tprofile::timed("vkCreatePipelineLayout", vkCreatePipelineLayout, device, &pipelineLayoutCreateInfo, nullptr, &mipGenPipelineLayout) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to make mip generation pipeline layout");
+		}
+
+		auto computeShaderCode = readShaderFile("shaders/mipgen.comp.spv");
+		VkShaderModule computeShaderModule = createShaderModule(computeShaderCode, device);
+
+		VkComputePipelineCreateInfo pipelineInfo{};
+		pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		pipelineInfo.stage.module = computeShaderModule;
+		pipelineInfo.stage.pName = "main";
+		pipelineInfo.layout = mipGenPipelineLayout;
+		pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
+		pipelineInfo.basePipelineIndex = -1;
+		if (tprofile::timed("vkCreateComputePipelines", vkCreateComputePipelines, device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &mipGenPipeline) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create mip generation pipeline");
+		}
+		vkDestroyShaderModule(device, computeShaderModule, nullptr);
+		DEBUG_NAME(device, VK_OBJECT_TYPE_PIPELINE_LAYOUT, mipGenPipelineLayout, "mip generation pipeline layout");
+		DEBUG_NAME(device, VK_OBJECT_TYPE_PIPELINE, mipGenPipeline, "mip generation pipeline");
+
+		// the shader counts finished workgroups in here so the last one knows it can do the tail of the chain
+		createBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			     mipGenCounterBuffer, mipGenCounterBufferMemory);
+		DEBUG_NAME(device, VK_OBJECT_TYPE_BUFFER, mipGenCounterBuffer, "mip generation counter");
+	}
+
+	// 0 when the graphics queue cant write timestamps at all
+	uint32_t graphicsQueueTimestampBits(void)
+	{
+		p_device::QueueFamilyIndices queueFamilyIndices = trequirement::findQueuFamilies(physicalDevice, surface);
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+		return queueFamilies[queueFamilyIndices.graphicsFamily.value()].timestampValidBits;
+	}
+
+	void createGpuTimers(void)
+	{
+		uint32_t validBits = graphicsQueueTimestampBits();
+		float period = deviceCapabilities.properties.limits.timestampPeriod;
+		frameTimers.create(device, framesInFlight, FRAME_TIMER_SCOPES, period, validBits);
+		uploadTimers.create(device, UPLOAD_TIMER_SLOTS, 1, period, validBits);
+		if (tsettings::settings.pipelineStats) {
+			if (deviceCapabilities.pipelineStatisticsQuery)
+				pipelineStats.create(device, framesInFlight);
+			else
+				std::cout << "pipeline statistics queries are not supported, --pipeline-stats does nothing" << std::endl;
+		}
 	}
 
+	// a query cant stay active across vkCmdExecuteCommands without inheritedQueries, so recording into secondaries
+	// turns counting off on devices that dont have it
+	bool countingPipelineStats(void) { return pipelineStats.enabled() && (recordChunkCount == 0 || deviceCapabilities.inheritedQueries); }
+
+	// expects every level in TRANSFER_DST_OPTIMAL with level 0 filled in, leaves every level in SHADER_READ_ONLY_OPTIMAL
 	void generateMipMaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
+	{
+		// timed under the path it took so the two can be compared with --mipgen=blit, --mipgen=compute and --report-gpu-time
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands(useComputeMipGen ? "mip generation (compute)" : "mip generation (blit)");
+
+		MipGenScratch scratch{};
+		{
+			DEBUG_LABEL(commandBuffer, "mip generation");
+			if (useComputeMipGen) {
+				recordComputeMipMaps(commandBuffer, image, texWidth, texHeight, mipLevels, scratch);
+			} else {
+				recordBlitMipMaps(commandBuffer, image, imageFormat, texWidth, texHeight, mipLevels);
+			}
+		}
+
+		// the scratch views and descriptor pool cant be destroyed while the gpu still uses them
+		waitForTransfer(endSingleTimeCommands(commandBuffer));
+
+		for (auto view : scratch.levelViews) {
+			vkDestroyImageView(device, view, nullptr);
+		}
+		if (scratch.descriptorPool != VK_NULL_HANDLE) {
+			vkDestroyDescriptorPool(device, scratch.descriptorPool, nullptr);
+		}
+	}
+
+	void recordComputeMipMaps(VkCommandBuffer commandBuffer, VkImage image, int32_t texWidth, int32_t texHeight, uint32_t mipLevels, MipGenScratch &scratch)
+	{
+		// one unorm view per level, allowed because the image was made with the mutable format bit
+		for (uint32_t i = 0; i < mipLevels; ++i) {
+			scratch.levelViews.push_back(createImageView(image, VK_FORMAT_R8G8B8A8_UNORM, VK_IMAGE_ASPECT_COLOR_BIT, 1, i));
+		}
+
+		// usually one dispatch does it, textures bigger than 4k need another one starting from where the first stopped
+		std::vector<std::pair<uint32_t, uint32_t>> dispatches; // source level, mips written
+		for (uint32_t base = 0; base + 1 < mipLevels;) {
+			uint32_t count = std::min(mipLevels - 1 - base, MIPGEN_MAX_MIPS_PER_DISPATCH);
+			// the last workgroup does the tail alone, so the 6th mip has to fit in the 64x64 tile it can handle
+			if ((std::max(texWidth >> base, texHeight >> base) >> 6) > 64)
+				count = std::min(count, MIPGEN_MAX_MIPS_PER_DISPATCH / 2);
+			dispatches.push_back({base, count});
+			base += count;
+		}
+		if (dispatches.empty()) {
+			transitionMipChain(commandBuffer, image, mipLevels, tgraph::access::transferWrite, tgraph::access::fragmentSampledRead);
+			return;
+		}
+
+		std::array<VkDescriptorPoolSize, 2> poolSizes{};
+		poolSizes[0].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		poolSizes[0].descriptorCount = static_cast<uint32_t>(dispatches.size()) * (MIPGEN_MAX_MIPS_PER_DISPATCH + 1);
+		poolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		poolSizes[1].descriptorCount = static_cast<uint32_t>(dispatches.size());
+		VkDescriptorPoolCreateInfo poolInfo{};
+		poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+		poolInfo.pPoolSizes = poolSizes.data();
+		poolInfo.maxSets = static_cast<uint32_t>(dispatches.size());
+		if (tprofile::timed("vkCreateDescriptorPool", vkCreateDescriptorPool, device, &poolInfo, nullptr, &scratch.descriptorPool) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create mip generation descriptor pool");
+		}
+
+		transitionMipChain(commandBuffer, image, mipLevels, tgraph::access::transferWrite, tgraph::access::computeStorageReadWrite);
+		vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mipGenPipeline);
+
+		for (const auto &[base, count] : dispatches) {
+			VkDescriptorSetAllocateInfo allocInfo{};
+			allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			allocInfo.descriptorPool = scratch.descriptorPool;
+			allocInfo.descriptorSetCount = 1;
+			allocInfo.pSetLayouts = &mipGenDescriptorSetLayout;
+			VkDescriptorSet descriptorSet;
+			if (vkAllocateDescriptorSets(device, &allocInfo, &descriptorSet) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate mip generation descriptor set");
+			}
+
+			VkDescriptorImageInfo srcInfo{};
+			srcInfo.imageView = scratch.levelViews[base];
+			srcInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			// slots past count are never touched by the shader, but they still need something valid in them
+			std::array<VkDescriptorImageInfo, MIPGEN_MAX_MIPS_PER_DISPATCH> dstInfos{};
+			for (uint32_t i = 0; i < MIPGEN_MAX_MIPS_PER_DISPATCH; ++i) {
+				dstInfos[i].imageView = scratch.levelViews[base + std::min(i + 1, count)];
+				dstInfos[i].imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+			}
+			VkDescriptorBufferInfo counterInfo{};
+			counterInfo.buffer = mipGenCounterBuffer;
+			counterInfo.offset = 0;
+			counterInfo.range = sizeof(uint32_t);
+
+			std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+			descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[0].dstSet = descriptorSet;
+			descriptorWrites[0].dstBinding = 0;
+			descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			descriptorWrites[0].descriptorCount = 1;
+			descriptorWrites[0].pImageInfo = &srcInfo;
+			descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[1].dstSet = descriptorSet;
+			descriptorWrites[1].dstBinding = 1;
+			descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+			descriptorWrites[1].descriptorCount = MIPGEN_MAX_MIPS_PER_DISPATCH;
+			descriptorWrites[1].pImageInfo = dstInfos.data();
+			descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			descriptorWrites[2].dstSet = descriptorSet;
+			descriptorWrites[2].dstBinding = 2;
+			descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			descriptorWrites[2].descriptorCount = 1;
+			descriptorWrites[2].pBufferInfo = &counterInfo;
+			vkUpdateDescriptorSets(device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+
+			vkCmdFillBuffer(commandBuffer, mipGenCounterBuffer, 0, sizeof(uint32_t), 0);
+			VkMemoryBarrier counterBarrier{};
+			counterBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			counterBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			counterBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &counterBarrier, 0, nullptr, 0,
+					     nullptr);
+
+			int32_t srcWidth = std::max(texWidth >> base, 1);
+			int32_t srcHeight = std::max(texHeight >> base, 1);
+			uint32_t groupsX = (static_cast<uint32_t>(srcWidth) + 63) / 64;
+			uint32_t groupsY = (static_cast<uint32_t>(srcHeight) + 63) / 64;
+			MipGenPushConstants pushConstants{};
+			pushConstants.srcSize[0] = srcWidth;
+			pushConstants.srcSize[1] = srcHeight;
+			pushConstants.mipCount = static_cast<int32_t>(count);
+			pushConstants.workGroupCount = static_cast<int32_t>(groupsX * groupsY);
+
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, mipGenPipelineLayout, 0, 1, &descriptorSet, 0, nullptr);
+			vkCmdPushConstants(commandBuffer, mipGenPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+			vkCmdDispatch(commandBuffer, groupsX, groupsY, 1);
+
+			// next dispatch reads what this one wrote and resets the counter this one used
+			VkMemoryBarrier dispatchBarrier{};
+			dispatchBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+			dispatchBarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+			dispatchBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+					     1, &dispatchBarrier, 0, nullptr, 0, nullptr);
+		}
+
+		transitionMipChain(commandBuffer, image, mipLevels, tgraph::access::computeStorageReadWrite, tgraph::access::fragmentSampledRead);
+	}
+
+	void transitionMipChain(VkCommandBuffer commandBuffer, VkImage image, uint32_t mipLevels, tgraph::access previous, tgraph::access next)
+	{
+		tgraph::imageBarrier(commandBuffer, image, {VK_IMAGE_ASPECT_COLOR_BIT, 0, mipLevels, 0, 1}, previous, next);
+	}
+
+	void recordBlitMipMaps(VkCommandBuffer commandBuffer, VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels)
 	{
 		// check linear blitting support
 		VkFormatProperties formatProperties;
@@ -1321,28 +3031,14 @@ class TriangleApp
 			throw std::runtime_error("texture image format does not support linear blitting");
 		}
 
-		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-		VkImageMemoryBarrier barrier{};
-		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-		barrier.image = image;
-		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		barrier.subresourceRange.baseArrayLayer = 0;
-		barrier.subresourceRange.layerCount = 1;
-		barrier.subresourceRange.levelCount = 1;
+		VkImageSubresourceRange level{VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
 
 		int32_t mipWidth = texWidth;
 		int32_t mipHeight = texHeight;
 		for (uint32_t i = 1; i < mipLevels; ++i) {
-			barrier.subresourceRange.baseMipLevel = i - 1;
-			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-			barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-					     &barrier);
+			// each level is written (by the copy or the previous blit), then read by the next blit, then only sampled
+			level.baseMipLevel = i - 1;
+			tgraph::imageBarrier(commandBuffer, image, level, tgraph::access::transferWrite, tgraph::access::transferRead);
 			VkImageBlit blit{};
 			blit.srcOffsets[0] = {0, 0, 0};
 			blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
@@ -1360,13 +3056,7 @@ class TriangleApp
 			vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit,
 				       VK_FILTER_LINEAR);
 
-			barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-			barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-			barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-			vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-					     &barrier);
+			tgraph::imageBarrier(commandBuffer, image, level, tgraph::access::transferRead, tgraph::access::fragmentSampledRead);
 
 			if (mipWidth > 1)
 				mipWidth /= 2;
@@ -1374,22 +3064,13 @@ class TriangleApp
 				mipHeight /= 2;
 		}
 
-		barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
-				     &barrier);
-
-		endSingleTimeCommands(commandBuffer);
+		level.baseMipLevel = mipLevels - 1;
+		tgraph::imageBarrier(commandBuffer, image, level, tgraph::access::transferWrite, tgraph::access::fragmentSampledRead);
 	}
 
 	VkSampleCountFlagBits getMaxUsableSampleCount()
 	{
-		VkPhysicalDeviceProperties physicalDeviceProperties;
-		vkGetPhysicalDeviceProperties(physicalDevice, &physicalDeviceProperties);
+		const VkPhysicalDeviceProperties &physicalDeviceProperties = deviceCapabilities.properties;
 
 		VkSampleCountFlags counts = physicalDeviceProperties.limits.framebufferColorSampleCounts & physicalDeviceProperties.limits.framebufferDepthSampleCounts;
 		if (counts & VK_SAMPLE_COUNT_64_BIT) { return VK_SAMPLE_COUNT_64_BIT; }
@@ -1401,20 +3082,21 @@ class TriangleApp
 
 		return VK_SAMPLE_COUNT_1_BIT;
 	}
-
-	void createColorResources(void)
-	{
-		VkFormat colorFormat = swapchainInfo.swapchainImageFormat;
-		auto extent = swapchainInfo.swapchainExtent;
-		createImage(extent.width, extent.height, 1, msaaSamples, colorFormat, VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, colorImage, colorImageMemory);
-		colorImageView = createImageView(colorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
-	}
 };
 
-int main(void)
+int main(int argc, char **argv)
 {
 	TriangleApp app;
 	try {
+		tsettings::parseArguments(argc, argv);
+		tpixel::init();
+		if (tsettings::settings.benchPixels || tsettings::settings.benchJobs) {
+			if (tsettings::settings.benchPixels)
+				tpixel::runBenchmarks();
+			if (tsettings::settings.benchJobs)
+				tjobs::runBenchmarks();
+			return EXIT_SUCCESS;
+		}
 		app.run();
 	} catch (const std::exception &e) {
 		std::cerr << e.what() << std::endl;
@@ -0,0 +1,77 @@
+#ifndef TRIANGLE_MPSC_QUEUE_HEADER
+#define TRIANGLE_MPSC_QUEUE_HEADER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// bounded lock free ring buffer for any number of producer threads and one consumer thread, nobody ever blocks.
+// producers claim a slot by bumping writeIndex and publish it through the slots sequence number, so the consumer
+// only sees a slot once whoever claimed it is done writing. a producer stalled between the two holds back the
+// consumer (not the other producers) until it finishes
+namespace tqueue {
+
+template <typename T, size_t Capacity> class MpscQueue {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity has to be a power of two");
+
+      public:
+	MpscQueue()
+	{
+		for (size_t i = 0; i < Capacity; ++i) {
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	// any thread, false when the ring is full and value was not added
+	bool push(T value)
+	{
+		size_t write = writeIndex.load(std::memory_order_relaxed);
+		for (;;) {
+			slot &s = slots[write & (Capacity - 1)];
+			size_t sequence = s.sequence.load(std::memory_order_acquire);
+			intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(write);
+			if (difference == 0) {
+				// free for this lap, the failed exchange reloads write for the next try
+				if (writeIndex.compare_exchange_weak(write, write + 1, std::memory_order_relaxed)) {
+					s.value = std::move(value);
+					s.sequence.store(write + 1, std::memory_order_release);
+					return true;
+				}
+			} else if (difference < 0) {
+				// still holds something from the previous lap
+				return false;
+			} else {
+				write = writeIndex.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	// consumer only, false when there was nothing to take
+	bool pop(T &value)
+	{
+		slot &s = slots[readIndex & (Capacity - 1)];
+		if (s.sequence.load(std::memory_order_acquire) != readIndex + 1)
+			return false;
+		value = std::move(s.value);
+		// hands the slot to the producer one lap ahead
+		s.sequence.store(readIndex + Capacity, std::memory_order_release);
+		++readIndex;
+		return true;
+	}
+
+      private:
+	struct slot {
+		std::atomic<size_t> sequence;
+		T value;
+	};
+	std::array<slot, Capacity> slots;
+	// indices only ever go up, the slot is the index masked by the capacity
+	alignas(64) std::atomic<size_t> writeIndex{0};
+	alignas(64) size_t readIndex = 0;
+};
+
+} // namespace tqueue
+
+#endif
@@ -1,10 +1,13 @@
 #include "p_device.hpp"
+#include "profiler.hpp"
 #include <cstdint>
 #include <stdexcept>
 #include <vulkan/vulkan_core.h>
 #include <vector>
 #include "p_device.hpp"
 #include <set>
+#include <string.h>
+#include <algorithm>
 #include "requirement.hpp"
 
 using namespace p_device;
@@ -27,7 +30,92 @@ void p_device::pickPhysicalDevice(VkPhysicalDevice *handle_storage, const VkInst
 	}
 }
 
-void p_device::createLogicalDevice(VkDevice *handle_device, const VkPhysicalDevice &device, VkQueue *handle_graphicsQueue, VkQueue *handle_presentQueue, const VkSurfaceKHR& surface)
+static bool deviceSupportsExtension(const VkPhysicalDevice &device, const char *name)
+{
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
+	return std::any_of(availableExtensions.begin(), availableExtensions.end(),
+			   [name](const VkExtensionProperties &extension) { return strcmp(name, extension.extensionName) == 0; });
+}
+
+DeviceCapabilities p_device::queryDeviceCapabilities(const VkPhysicalDevice &device)
+{
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+	DeviceCapabilities capabilities{};
+	vkGetPhysicalDeviceProperties(device, &capabilities.properties);
+	const VkPhysicalDeviceProperties &properties = capabilities.properties;
+	capabilities.storageImageArrayDynamicIndexing = supportedFeatures.shaderStorageImageArrayDynamicIndexing;
+	capabilities.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+	capabilities.inheritedQueries = supportedFeatures.inheritedQueries;
+	capabilities.imageViewUsage =
+	    properties.apiVersion >= VK_API_VERSION_1_1 || deviceSupportsExtension(device, VK_KHR_MAINTENANCE2_EXTENSION_NAME);
+
+	//the *2 queries are core in 1.1, older devices just dont get any of the extension features
+	if (properties.apiVersion < VK_API_VERSION_1_1)
+		return capabilities;
+
+	if (deviceSupportsExtension(device, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+		VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+		indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &indexingFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+
+		VkPhysicalDeviceDescriptorIndexingPropertiesEXT indexingProperties{};
+		indexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES_EXT;
+		VkPhysicalDeviceProperties2 properties2{};
+		properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		properties2.pNext = &indexingProperties;
+		vkGetPhysicalDeviceProperties2(device, &properties2);
+
+		//the shader indexes the table with a push constant, thats dynamically uniform indexing of a sampled image array
+		capabilities.descriptorIndexing = supportedFeatures.shaderSampledImageArrayDynamicIndexing && indexingFeatures.runtimeDescriptorArray &&
+						  indexingFeatures.descriptorBindingPartiallyBound &&
+						  indexingFeatures.descriptorBindingSampledImageUpdateAfterBind &&
+						  indexingFeatures.descriptorBindingUpdateUnusedWhilePending;
+		capabilities.maxBindlessTextures = std::min(indexingProperties.maxDescriptorSetUpdateAfterBindSampledImages,
+							    indexingProperties.maxPerStageDescriptorUpdateAfterBindSampledImages);
+	}
+
+	if (deviceSupportsExtension(device, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+		VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+		timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &timelineFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+		capabilities.timelineSemaphore = timelineFeatures.timelineSemaphore;
+	}
+
+	if (deviceSupportsExtension(device, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+		VkPhysicalDeviceSynchronization2FeaturesKHR sync2Features{};
+		sync2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &sync2Features;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+		capabilities.synchronization2 = sync2Features.synchronization2;
+	}
+
+	if (deviceSupportsExtension(device, VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME) && deviceSupportsExtension(device, VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME) &&
+	    deviceSupportsExtension(device, VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME)) {
+		VkPhysicalDeviceDynamicRenderingFeaturesKHR renderingFeatures{};
+		renderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+		VkPhysicalDeviceFeatures2 features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features2.pNext = &renderingFeatures;
+		vkGetPhysicalDeviceFeatures2(device, &features2);
+		capabilities.dynamicRendering = renderingFeatures.dynamicRendering;
+	}
+	return capabilities;
+}
+
+void p_device::createLogicalDevice(VkDevice *handle_device, const VkPhysicalDevice &device, VkQueue *handle_graphicsQueue, VkQueue *handle_presentQueue, const VkSurfaceKHR& surface,
+				   const DeviceCapabilities &capabilities)
 {
 	QueueFamilyIndices indices = findQueuFamilies(device, surface);
 
@@ -47,14 +135,70 @@ void p_device::createLogicalDevice(VkDevice *handle_device, const VkPhysicalDevi
 	//liek right now
 	deviceFeatures.samplerAnisotropy = VK_TRUE;
 	deviceFeatures.sampleRateShading = VK_TRUE; //more quality in image at a cost
+	deviceFeatures.shaderStorageImageArrayDynamicIndexing = capabilities.storageImageArrayDynamicIndexing;
+	deviceFeatures.pipelineStatisticsQuery = capabilities.pipelineStatisticsQuery;
+	deviceFeatures.inheritedQueries = capabilities.inheritedQueries;
+
+	//optional extensions and their feature structs, each one that is supported gets pushed on the front of the pNext chain
+	std::vector<const char*> extensions = requiredDeviceExtensions;
+	void *featureChain = nullptr;
+
+	//core from 1.1, only a 1.0 device has to turn it on
+	if (capabilities.imageViewUsage && capabilities.properties.apiVersion < VK_API_VERSION_1_1)
+		extensions.push_back(VK_KHR_MAINTENANCE2_EXTENSION_NAME);
+
+	VkPhysicalDeviceDescriptorIndexingFeaturesEXT indexingFeatures{};
+	indexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES_EXT;
+	if (capabilities.descriptorIndexing) {
+		extensions.push_back(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+		deviceFeatures.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+		indexingFeatures.runtimeDescriptorArray = VK_TRUE;
+		indexingFeatures.descriptorBindingPartiallyBound = VK_TRUE;
+		indexingFeatures.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+		indexingFeatures.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+		indexingFeatures.pNext = featureChain;
+		featureChain = &indexingFeatures;
+	}
+
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+	timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+	if (capabilities.timelineSemaphore) {
+		extensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		timelineFeatures.timelineSemaphore = VK_TRUE;
+		timelineFeatures.pNext = featureChain;
+		featureChain = &timelineFeatures;
+	}
+
+	VkPhysicalDeviceSynchronization2FeaturesKHR sync2Features{};
+	sync2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+	if (capabilities.synchronization2) {
+		extensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+		sync2Features.synchronization2 = VK_TRUE;
+		sync2Features.pNext = featureChain;
+		featureChain = &sync2Features;
+	}
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR renderingFeatures{};
+	renderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+	if (capabilities.dynamicRendering) {
+		//multiview and maintenance2, the other two it depends on, are core in 1.1
+		extensions.push_back(VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME);
+		extensions.push_back(VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME);
+		extensions.push_back(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME);
+		renderingFeatures.dynamicRendering = VK_TRUE;
+		renderingFeatures.pNext = featureChain;
+		featureChain = &renderingFeatures;
+	}
+
 	//that does it for the queue we want, now to make the device itself
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = featureChain;
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.pEnabledFeatures = &deviceFeatures;
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(requiredDeviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = requiredDeviceExtensions.data();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
+	createInfo.ppEnabledExtensionNames = extensions.data();
 	//for older implementations, the info for validation layers should be set. newer implementations ignore this
 	//because there is no more distinction between device and instance specific validation layers.
 	//to be compatible this info should be set, but im lazy and the info is in another file so im leaving it blank for now
@@ -62,7 +206,7 @@ void p_device::createLogicalDevice(VkDevice *handle_device, const VkPhysicalDevi
 	createInfo.enabledLayerCount = 0;
 	createInfo.ppEnabledLayerNames = nullptr;
 
-	if (vkCreateDevice(device, &createInfo, nullptr, handle_device) != VK_SUCCESS) {
+	if (tprofile::timed("vkCreateDevice", vkCreateDevice, device, &createInfo, nullptr, handle_device) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to create logical vulkan device.");
 	}
 
@@ -13,8 +13,24 @@ namespace p_device{
 
 const float queuePriority = 1.0f;
 
+//optional stuff the device may or may not do, we enable whatever is supported when creating the logical device
+struct DeviceCapabilities {
+	VkPhysicalDeviceProperties properties{}; //queried once here, use this instead of calling vkGetPhysicalDeviceProperties again
+	bool storageImageArrayDynamicIndexing = false; //needed by the compute mip generator
+	bool imageViewUsage = false; //VkImageViewUsageCreateInfo, core in 1.1 or VK_KHR_maintenance2. the compute mip generator needs it for its srgb view
+	bool descriptorIndexing = false; //VK_EXT_descriptor_indexing with everything the bindless texture table uses, dynamic sampled image indexing included
+	uint32_t maxBindlessTextures = 0; //update after bind sampled image limit, only meaningful with descriptorIndexing
+	bool timelineSemaphore = false; //VK_KHR_timeline_semaphore, lets frames and uploads wait on counters instead of fences and idle queues
+	bool synchronization2 = false; //VK_KHR_synchronization2, the render graph falls back to vkCmdPipelineBarrier without it
+	bool dynamicRendering = false; //VK_KHR_dynamic_rendering (+ depth_stencil_resolve and create_renderpass2 it needs), render without VkRenderPass/VkFramebuffer
+	bool pipelineStatisticsQuery = false; //counts shader invocations and clipped primitives
+	bool inheritedQueries = false; //a query can stay active across vkCmdExecuteCommands, needed to count draws recorded into secondaries
+};
+
 void pickPhysicalDevice(VkPhysicalDevice *handle_storage, const VkInstance &instance, const VkSurfaceKHR& surface);
-void createLogicalDevice(VkDevice *handle_device, const VkPhysicalDevice &device, VkQueue *handle_graphicsQueue, VkQueue *handle_presentQueue, const VkSurfaceKHR& surface);
+DeviceCapabilities queryDeviceCapabilities(const VkPhysicalDevice &device);
+void createLogicalDevice(VkDevice *handle_device, const VkPhysicalDevice &device, VkQueue *handle_graphicsQueue, VkQueue *handle_presentQueue, const VkSurfaceKHR& surface,
+			 const DeviceCapabilities &capabilities);
 
 struct QueueFamilyIndices{
 	std::optional<uint32_t> graphicsFamily;
@@ -0,0 +1,78 @@
+#include "pipelineStats.hpp"
+#include "profiler.hpp"
+#include <stdexcept>
+
+void tgputime::PipelineStats::create(VkDevice device, uint32_t slotCount)
+{
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+	queryPoolInfo.queryCount = slotCount;
+	queryPoolInfo.pipelineStatistics = PIPELINE_STATISTICS;
+	if (tprofile::timed("vkCreateQueryPool", vkCreateQueryPool, device, &queryPoolInfo, nullptr, &pool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create pipeline statistics query pool");
+	}
+	pending.assign(slotCount, false);
+	recorded.assign(slotCount, false);
+}
+
+void tgputime::PipelineStats::destroy(VkDevice device)
+{
+	if (pool == VK_NULL_HANDLE)
+		return;
+	vkDestroyQueryPool(device, pool, nullptr);
+	pool = VK_NULL_HANDLE;
+}
+
+void tgputime::PipelineStats::reset(VkCommandBuffer commandBuffer, uint32_t slot)
+{
+	if (pool != VK_NULL_HANDLE)
+		vkCmdResetQueryPool(commandBuffer, pool, slot, 1);
+}
+
+void tgputime::PipelineStats::begin(VkCommandBuffer commandBuffer, uint32_t slot)
+{
+	if (pool == VK_NULL_HANDLE)
+		return;
+	vkCmdBeginQuery(commandBuffer, pool, slot, 0);
+	recorded[slot] = true;
+}
+
+void tgputime::PipelineStats::end(VkCommandBuffer commandBuffer, uint32_t slot)
+{
+	if (pool != VK_NULL_HANDLE)
+		vkCmdEndQuery(commandBuffer, pool, slot);
+}
+
+void tgputime::PipelineStats::submitted(uint32_t slot)
+{
+	if (pool != VK_NULL_HANDLE && recorded[slot])
+		pending[slot] = true;
+}
+
+void tgputime::PipelineStats::collect(VkDevice device, uint32_t slot)
+{
+	if (pool == VK_NULL_HANDLE || !pending[slot])
+		return;
+	pending[slot] = false;
+	// the four counters and then availability
+	uint64_t results[5];
+	VkResult result = vkGetQueryPoolResults(device, pool, slot, 1, sizeof(results), results, sizeof(results),
+						VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+	if ((result != VK_SUCCESS && result != VK_NOT_READY) || results[4] == 0)
+		return;
+	totals.vertexInvocations += results[0];
+	totals.clippingInvocations += results[1];
+	totals.clippingPrimitives += results[2];
+	totals.fragmentInvocations += results[3];
+	++totalFrames;
+}
+
+tgputime::pipelineCounters tgputime::PipelineStats::takeTotals(uint32_t &frames)
+{
+	pipelineCounters taken = totals;
+	frames = totalFrames;
+	totals = {};
+	totalFrames = 0;
+	return taken;
+}
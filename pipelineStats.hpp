@@ -0,0 +1,52 @@
+#ifndef TRIANGLE_PIPELINE_STATS_HEADER
+#define TRIANGLE_PIPELINE_STATS_HEADER
+
+#include <cstdint>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+// pipeline statistics queries, one per frame slot, summed up until someone takes the totals. read back the same way as
+// the gpu timers: only once the slot is known to be done, so it never waits
+namespace tgputime {
+
+// what gets counted, the results come back in this order (lowest bit first)
+const VkQueryPipelineStatisticFlags PIPELINE_STATISTICS = VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+							  VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT |
+							  VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+							  VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+struct pipelineCounters {
+	uint64_t vertexInvocations = 0;
+	uint64_t clippingInvocations = 0; // primitives that reached clipping
+	uint64_t clippingPrimitives = 0;  // primitives clipping let through, fewer than went in when things got culled
+	uint64_t fragmentInvocations = 0;
+};
+
+class PipelineStats {
+      public:
+	void create(VkDevice device, uint32_t slotCount);
+	void destroy(VkDevice device);
+	bool enabled() const { return pool != VK_NULL_HANDLE; }
+
+	// reset goes outside a render pass, begin and end go around the draws either both inside one or both outside
+	void reset(VkCommandBuffer commandBuffer, uint32_t slot);
+	void begin(VkCommandBuffer commandBuffer, uint32_t slot);
+	void end(VkCommandBuffer commandBuffer, uint32_t slot);
+	void submitted(uint32_t slot);
+	// adds what the slots last submission counted to the totals, dropped if it isnt available yet
+	void collect(VkDevice device, uint32_t slot);
+
+	// sums since the last take and how many frames they are over, then starts over
+	pipelineCounters takeTotals(uint32_t &frames);
+
+      private:
+	VkQueryPool pool = VK_NULL_HANDLE;
+	std::vector<bool> pending; // submitted and not collected yet
+	std::vector<bool> recorded; // the slot had a query recorded into it, a cached command buffer can be submitted many times
+	pipelineCounters totals;
+	uint32_t totalFrames = 0;
+};
+
+} // namespace tgputime
+
+#endif
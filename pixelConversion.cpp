@@ -0,0 +1,646 @@
+#include "pixelConversion.hpp"
+#include "settings.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+// the sse4/avx2 kernels only exist on x86, everything else always runs the scalar ones
+#if defined(__x86_64__) || defined(__i386__)
+#define TPIXEL_X86 1
+#include <immintrin.h>
+// the simd versions are compiled with target attributes instead of global -m flags so the binary still runs
+// on cpus without them, they only get called after __builtin_cpu_supports said yes
+#define TPIXEL_SSE4 __attribute__((target("sse4.1")))
+#define TPIXEL_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+namespace {
+
+struct kernelTable {
+	void (*expandRGBToRGBA)(uint8_t *dst, const uint8_t *src, size_t pixelCount);
+	void (*srgbToLinear)(float *dst, const uint8_t *src, size_t pixelCount);
+	void (*premultiplyAlpha)(uint8_t *dst, const uint8_t *src, size_t pixelCount);
+	void (*downsampleBox)(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight);
+	void (*downsampleKaiser)(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight);
+};
+
+// [0, 256) is srgb -> linear, [256, 512) is a plain /255 for alpha so the avx2 path can do everything with one gather
+std::array<float, 512> makeLinearTable()
+{
+	std::array<float, 512> table;
+	for (int i = 0; i < 256; ++i) {
+		float c = i / 255.0f;
+		table[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		table[256 + i] = c;
+	}
+	return table;
+}
+const std::array<float, 512> linearTable = makeLinearTable();
+
+// 2x decimation filter, tap i sits at i - 3.5 source pixels from the center of the output pixel
+const int KAISER_TAPS = 8;
+const float KAISER_BETA = 4.0f;
+
+float besselI0(float x)
+{
+	float sum = 1.0f;
+	float term = 1.0f;
+	for (int k = 1; k < 16; ++k) {
+		term *= (x / (2.0f * k)) * (x / (2.0f * k));
+		sum += term;
+	}
+	return sum;
+}
+
+std::array<float, KAISER_TAPS> makeKaiserWeights()
+{
+	std::array<float, KAISER_TAPS> weights;
+	float total = 0.0f;
+	for (int i = 0; i < KAISER_TAPS; ++i) {
+		float d = i - 3.5f;
+		float x = d * 0.5f * static_cast<float>(M_PI);
+		float sinc = std::sin(x) / x;
+		float r = d / (KAISER_TAPS / 2);
+		weights[i] = sinc * besselI0(KAISER_BETA * std::sqrt(1.0f - r * r)) / besselI0(KAISER_BETA);
+		total += weights[i];
+	}
+	for (auto &w : weights)
+		w /= total;
+	return weights;
+}
+const std::array<float, KAISER_TAPS> kaiserWeights = makeKaiserWeights();
+
+uint32_t halfSize(uint32_t size) { return std::max(size / 2, 1u); }
+
+// clamped source index of every tap for every output pixel, shared by the horizontal and vertical passes
+std::vector<uint32_t> kaiserTapIndices(uint32_t srcSize)
+{
+	uint32_t dstSize = halfSize(srcSize);
+	std::vector<uint32_t> indices(dstSize * KAISER_TAPS);
+	for (uint32_t x = 0; x < dstSize; ++x) {
+		for (int i = 0; i < KAISER_TAPS; ++i) {
+			int64_t s = static_cast<int64_t>(2 * x) - 3 + i;
+			indices[x * KAISER_TAPS + i] = static_cast<uint32_t>(std::clamp<int64_t>(s, 0, srcSize - 1));
+		}
+	}
+	return indices;
+}
+
+uint8_t toByte(float v) { return static_cast<uint8_t>(std::clamp(std::nearbyint(v), 0.0f, 255.0f)); }
+
+// ---- scalar ----
+
+void expandRGBToRGBAScalar(uint8_t *dst, const uint8_t *src, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; ++i) {
+		dst[4 * i + 0] = src[3 * i + 0];
+		dst[4 * i + 1] = src[3 * i + 1];
+		dst[4 * i + 2] = src[3 * i + 2];
+		dst[4 * i + 3] = 255;
+	}
+}
+
+void srgbToLinearScalar(float *dst, const uint8_t *src, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; ++i) {
+		dst[4 * i + 0] = linearTable[src[4 * i + 0]];
+		dst[4 * i + 1] = linearTable[src[4 * i + 1]];
+		dst[4 * i + 2] = linearTable[src[4 * i + 2]];
+		dst[4 * i + 3] = linearTable[256 + src[4 * i + 3]];
+	}
+}
+
+// exact round(c * a / 255) without a divide, the simd versions do the same thing 8 or 16 lanes at a time
+inline uint8_t mulDiv255(uint32_t c, uint32_t a)
+{
+	uint32_t t = c * a + 128;
+	return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+}
+
+void premultiplyAlphaScalar(uint8_t *dst, const uint8_t *src, size_t pixelCount)
+{
+	for (size_t i = 0; i < pixelCount; ++i) {
+		uint8_t a = src[4 * i + 3];
+		dst[4 * i + 0] = mulDiv255(src[4 * i + 0], a);
+		dst[4 * i + 1] = mulDiv255(src[4 * i + 1], a);
+		dst[4 * i + 2] = mulDiv255(src[4 * i + 2], a);
+		dst[4 * i + 3] = a;
+	}
+}
+
+// box filter for the dst pixels in [firstX, dstWidth) of one row, the simd versions use it for the leftovers
+void downsampleBoxRowScalar(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, uint32_t srcWidth, uint32_t firstX)
+{
+	uint32_t dstWidth = halfSize(srcWidth);
+	for (uint32_t x = firstX; x < dstWidth; ++x) {
+		uint32_t x0 = 2 * x;
+		uint32_t x1 = std::min(2 * x + 1, srcWidth - 1);
+		for (int c = 0; c < 4; ++c) {
+			uint32_t sum = row0[4 * x0 + c] + row0[4 * x1 + c] + row1[4 * x0 + c] + row1[4 * x1 + c];
+			dst[4 * x + c] = static_cast<uint8_t>((sum + 2) >> 2);
+		}
+	}
+}
+
+template <typename RowFunction> void downsampleBoxRows(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, RowFunction rowFunction)
+{
+	uint32_t dstWidth = halfSize(srcWidth);
+	uint32_t dstHeight = halfSize(srcHeight);
+	for (uint32_t y = 0; y < dstHeight; ++y) {
+		const uint8_t *row0 = src + static_cast<size_t>(2 * y) * srcWidth * 4;
+		const uint8_t *row1 = src + static_cast<size_t>(std::min(2 * y + 1, srcHeight - 1)) * srcWidth * 4;
+		rowFunction(dst + static_cast<size_t>(y) * dstWidth * 4, row0, row1, srcWidth);
+	}
+}
+
+void downsampleBoxScalar(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	downsampleBoxRows(dst, src, srcWidth, srcHeight,
+			  [](uint8_t *d, const uint8_t *r0, const uint8_t *r1, uint32_t w) { downsampleBoxRowScalar(d, r0, r1, w, 0); });
+}
+
+// separable: horizontal pass into a float row, then vertical pass into dst. the taps of one output row are 8
+// neighbouring source rows, so only those stay around in a ring (row r lives in slot r % 8) and it all fits in cache
+template <typename HorizontalFunction, typename VerticalFunction>
+void downsampleKaiserPasses(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight, HorizontalFunction horizontal, VerticalFunction vertical)
+{
+	uint32_t dstWidth = halfSize(srcWidth);
+	uint32_t dstHeight = halfSize(srcHeight);
+	size_t rowFloats = static_cast<size_t>(dstWidth) * 4;
+	std::vector<uint32_t> columns = kaiserTapIndices(srcWidth);
+	std::vector<uint32_t> rows = kaiserTapIndices(srcHeight);
+	std::vector<float> ring(rowFloats * KAISER_TAPS);
+	uint32_t rowsDone = 0;
+
+	for (uint32_t y = 0; y < dstHeight; ++y) {
+		const uint32_t *rowTaps = rows.data() + y * KAISER_TAPS;
+		for (; rowsDone <= rowTaps[KAISER_TAPS - 1]; ++rowsDone) {
+			horizontal(ring.data() + (rowsDone % KAISER_TAPS) * rowFloats, src + static_cast<size_t>(rowsDone) * srcWidth * 4, columns.data(), dstWidth);
+		}
+		std::array<const float *, KAISER_TAPS> taps;
+		for (int i = 0; i < KAISER_TAPS; ++i)
+			taps[i] = ring.data() + (rowTaps[i] % KAISER_TAPS) * rowFloats;
+		vertical(dst + static_cast<size_t>(y) * rowFloats, taps.data(), rowFloats);
+	}
+}
+
+void kaiserHorizontalScalar(float *dst, const uint8_t *src, const uint32_t *columns, uint32_t dstWidth)
+{
+	for (uint32_t x = 0; x < dstWidth; ++x) {
+		for (int c = 0; c < 4; ++c) {
+			float sum = 0.0f;
+			for (int i = 0; i < KAISER_TAPS; ++i)
+				sum += kaiserWeights[i] * src[4 * columns[x * KAISER_TAPS + i] + c];
+			dst[4 * x + c] = sum;
+		}
+	}
+}
+
+void kaiserVerticalScalar(uint8_t *dst, const float *const *taps, size_t first, size_t count)
+{
+	for (size_t j = first; j < count; ++j) {
+		float sum = 0.0f;
+		for (int i = 0; i < KAISER_TAPS; ++i)
+			sum += kaiserWeights[i] * taps[i][j];
+		dst[j] = toByte(sum);
+	}
+}
+
+void downsampleKaiserScalar(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	downsampleKaiserPasses(dst, src, srcWidth, srcHeight, kaiserHorizontalScalar,
+			       [](uint8_t *d, const float *const *taps, size_t count) { kaiserVerticalScalar(d, taps, 0, count); });
+}
+
+#ifdef TPIXEL_X86
+
+// ---- sse4 ----
+
+// 4 rgb pixels (12 bytes) -> 4 rgba pixels, 0x80 lanes come out as zero and get or'd with the alpha
+TPIXEL_SSE4 __m128i expandShuffle() { return _mm_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128); }
+
+TPIXEL_SSE4 void expandRGBToRGBASse4(uint8_t *dst, const uint8_t *src, size_t pixelCount)
+{
+	const __m128i shuffle = expandShuffle();
+	const __m128i alpha = _mm_set1_epi32(static_cast<int>(0xff000000));
+	size_t i = 0;
+	// each load reads 16 bytes but only uses 12, stop early enough to never read past the end of src
+	for (; i + 6 <= pixelCount; i += 4) {
+		__m128i rgb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 3 * i));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * i), _mm_or_si128(_mm_shuffle_epi8(rgb, shuffle), alpha));
+	}
+	expandRGBToRGBAScalar(dst + 4 * i, src + 3 * i, pixelCount - i);
+}
+
+// alpha of each pixel in its color lanes and 255 in its alpha lane, for 2 pixels widened to 16 bit
+TPIXEL_SSE4 __m128i alphaMultiplier(__m128i pixels, __m128i alphaShuffle, __m128i max)
+{
+	return _mm_blend_epi16(_mm_shuffle_epi8(pixels, alphaShuffle), max, 0x88);
+}
+
+TPIXEL_SSE4 __m128i mulDiv255Sse4(__m128i c, __m128i a)
+{
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(c, a), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+TPIXEL_SSE4 void premultiplyAlphaSse4(uint8_t *dst, const uint8_t *src, size_t pixelCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i max = _mm_set1_epi16(255);
+	const __m128i alphaShuffle = _mm_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15);
+	size_t i = 0;
+	for (; i + 4 <= pixelCount; i += 4) {
+		__m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 4 * i));
+		__m128i lo = _mm_unpacklo_epi8(pixels, zero);
+		__m128i hi = _mm_unpackhi_epi8(pixels, zero);
+		lo = mulDiv255Sse4(lo, alphaMultiplier(lo, alphaShuffle, max));
+		hi = mulDiv255Sse4(hi, alphaMultiplier(hi, alphaShuffle, max));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * i), _mm_packus_epi16(lo, hi));
+	}
+	premultiplyAlphaScalar(dst + 4 * i, src + 4 * i, pixelCount - i);
+}
+
+TPIXEL_SSE4 void downsampleBoxRowSse4(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, uint32_t srcWidth)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i rounding = _mm_set1_epi16(2);
+	uint32_t dstWidth = halfSize(srcWidth);
+	uint32_t x = 0;
+	// 4 source pixels from each row -> 2 dst pixels
+	for (; x + 2 <= dstWidth && 2 * x + 4 <= srcWidth; x += 2) {
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row0 + 8 * x));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(row1 + 8 * x));
+		__m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+		__m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+		// add the neighbouring pixel, the result for each pair ends up in the low 64 bits
+		lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+		hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+		__m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), rounding), 2);
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(dst + 4 * x), _mm_packus_epi16(sum, sum));
+	}
+	downsampleBoxRowScalar(dst, row0, row1, srcWidth, x);
+}
+
+TPIXEL_SSE4 void downsampleBoxSse4(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	downsampleBoxRows(dst, src, srcWidth, srcHeight, downsampleBoxRowSse4);
+}
+
+TPIXEL_SSE4 __m128 loadPixelSse4(const uint8_t *pixel)
+{
+	int32_t bits;
+	memcpy(&bits, pixel, sizeof(bits));
+	return _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(bits)));
+}
+
+TPIXEL_SSE4 void kaiserHorizontalSse4(float *dst, const uint8_t *src, const uint32_t *columns, uint32_t dstWidth)
+{
+	for (uint32_t x = 0; x < dstWidth; ++x) {
+		__m128 sum = _mm_setzero_ps();
+		for (int i = 0; i < KAISER_TAPS; ++i)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kaiserWeights[i]), loadPixelSse4(src + 4 * columns[x * KAISER_TAPS + i])));
+		_mm_storeu_ps(dst + 4 * x, sum);
+	}
+}
+
+TPIXEL_SSE4 void kaiserVerticalSse4(uint8_t *dst, const float *const *taps, size_t count)
+{
+	size_t j = 0;
+	for (; j + 4 <= count; j += 4) {
+		__m128 sum = _mm_setzero_ps();
+		for (int i = 0; i < KAISER_TAPS; ++i)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kaiserWeights[i]), _mm_loadu_ps(taps[i] + j)));
+		// cvtps rounds to nearest even like nearbyint, the packs clamp to [0, 255]
+		__m128i values = _mm_cvtps_epi32(sum);
+		values = _mm_packus_epi16(_mm_packus_epi32(values, values), values);
+		int32_t bits = _mm_cvtsi128_si32(values);
+		memcpy(dst + j, &bits, sizeof(bits));
+	}
+	kaiserVerticalScalar(dst, taps, j, count);
+}
+
+TPIXEL_SSE4 void downsampleKaiserSse4(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	downsampleKaiserPasses(dst, src, srcWidth, srcHeight, kaiserHorizontalSse4, kaiserVerticalSse4);
+}
+
+// ---- avx2 ----
+
+TPIXEL_AVX2 void expandRGBToRGBAAvx2(uint8_t *dst, const uint8_t *src, size_t pixelCount)
+{
+	// move the 24 bytes of 8 rgb pixels so each 128 bit lane holds 12 of them, then shuffle like the sse4 version
+	const __m256i spread = _mm256_setr_epi32(0, 1, 2, 0, 3, 4, 5, 0);
+	const __m256i shuffle = _mm256_setr_epi8(0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128, 0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128,
+						 9, 10, 11, -128);
+	const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xff000000));
+	size_t i = 0;
+	for (; i + 11 <= pixelCount; i += 8) {
+		__m256i rgb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 3 * i));
+		rgb = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(rgb, spread), shuffle);
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_or_si256(rgb, alpha));
+	}
+	expandRGBToRGBASse4(dst + 4 * i, src + 3 * i, pixelCount - i);
+}
+
+TPIXEL_AVX2 void srgbToLinearAvx2(float *dst, const uint8_t *src, size_t pixelCount)
+{
+	const __m256i alphaOffset = _mm256_setr_epi32(0, 0, 0, 256, 0, 0, 0, 256);
+	size_t i = 0;
+	for (; i + 2 <= pixelCount; i += 2) {
+		__m256i indices = _mm256_add_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + 4 * i))), alphaOffset);
+		_mm256_storeu_ps(dst + 4 * i, _mm256_i32gather_ps(linearTable.data(), indices, 4));
+	}
+	srgbToLinearScalar(dst + 4 * i, src + 4 * i, pixelCount - i);
+}
+
+TPIXEL_AVX2 __m256i mulDiv255Avx2(__m256i c, __m256i a)
+{
+	__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(c, a), _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+TPIXEL_AVX2 void premultiplyAlphaAvx2(uint8_t *dst, const uint8_t *src, size_t pixelCount)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i max = _mm256_set1_epi16(255);
+	const __m256i alphaShuffle = _mm256_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15, 6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14,
+						      15, 14, 15);
+	size_t i = 0;
+	// unpack and pack both work per 128 bit lane, so the pixel order survives without any permutes
+	for (; i + 8 <= pixelCount; i += 8) {
+		__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * i));
+		__m256i lo = _mm256_unpacklo_epi8(pixels, zero);
+		__m256i hi = _mm256_unpackhi_epi8(pixels, zero);
+		lo = mulDiv255Avx2(lo, _mm256_blend_epi16(_mm256_shuffle_epi8(lo, alphaShuffle), max, 0x88));
+		hi = mulDiv255Avx2(hi, _mm256_blend_epi16(_mm256_shuffle_epi8(hi, alphaShuffle), max, 0x88));
+		_mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + 4 * i), _mm256_packus_epi16(lo, hi));
+	}
+	premultiplyAlphaSse4(dst + 4 * i, src + 4 * i, pixelCount - i);
+}
+
+TPIXEL_AVX2 void downsampleBoxRowAvx2(uint8_t *dst, const uint8_t *row0, const uint8_t *row1, uint32_t srcWidth)
+{
+	const __m256i rounding = _mm256_set1_epi16(2);
+	uint32_t dstWidth = halfSize(srcWidth);
+	uint32_t x = 0;
+	// 8 source pixels from each row -> 4 dst pixels
+	for (; x + 4 <= dstWidth && 2 * x + 8 <= srcWidth; x += 4) {
+		const uint8_t *a = row0 + 8 * x;
+		const uint8_t *b = row1 + 8 * x;
+		__m256i first = _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a))),
+						 _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b))));
+		__m256i second = _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 16))),
+						  _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 16))));
+		first = _mm256_add_epi16(first, _mm256_srli_si256(first, 8));
+		second = _mm256_add_epi16(second, _mm256_srli_si256(second, 8));
+		// lanes are now [d0 d2 | d1 d3], put them back in order
+		__m256i sum = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(first, second), 0xd8);
+		sum = _mm256_srli_epi16(_mm256_add_epi16(sum, rounding), 2);
+		__m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 4 * x), packed);
+	}
+	downsampleBoxRowScalar(dst, row0, row1, srcWidth, x);
+}
+
+TPIXEL_AVX2 void downsampleBoxAvx2(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	downsampleBoxRows(dst, src, srcWidth, srcHeight, downsampleBoxRowAvx2);
+}
+
+TPIXEL_AVX2 void kaiserHorizontalAvx2(float *dst, const uint8_t *src, const uint32_t *columns, uint32_t dstWidth)
+{
+	// weights for pixel pairs (0 1) (2 3) (4 5) (6 7) of the 8 taps
+	__m256 weights[KAISER_TAPS / 2];
+	for (int i = 0; i < KAISER_TAPS / 2; ++i) {
+		weights[i] = _mm256_setr_ps(kaiserWeights[2 * i], kaiserWeights[2 * i], kaiserWeights[2 * i], kaiserWeights[2 * i], kaiserWeights[2 * i + 1],
+					    kaiserWeights[2 * i + 1], kaiserWeights[2 * i + 1], kaiserWeights[2 * i + 1]);
+	}
+	for (uint32_t x = 0; x < dstWidth; ++x) {
+		const uint32_t *taps = columns + x * KAISER_TAPS;
+		if (taps[KAISER_TAPS - 1] - taps[0] != KAISER_TAPS - 1) {
+			// clamped at an edge, not worth vectorizing differently
+			kaiserHorizontalSse4(dst + 4 * x, src, taps, 1);
+			continue;
+		}
+		// away from the edges the taps are 8 neighbouring pixels, one 32 byte load
+		__m256i pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 4 * taps[0]));
+		__m128i lo = _mm256_castsi256_si128(pixels);
+		__m128i hi = _mm256_extracti128_si256(pixels, 1);
+		__m256 sum = _mm256_mul_ps(weights[0], _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(lo)));
+		sum = _mm256_fmadd_ps(weights[1], _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8))), sum);
+		sum = _mm256_fmadd_ps(weights[2], _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(hi)), sum);
+		sum = _mm256_fmadd_ps(weights[3], _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8))), sum);
+		_mm_storeu_ps(dst + 4 * x, _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1)));
+	}
+}
+
+TPIXEL_AVX2 void kaiserVerticalAvx2(uint8_t *dst, const float *const *taps, size_t count)
+{
+	size_t j = 0;
+	for (; j + 8 <= count; j += 8) {
+		__m256 sum = _mm256_setzero_ps();
+		for (int i = 0; i < KAISER_TAPS; ++i)
+			sum = _mm256_fmadd_ps(_mm256_set1_ps(kaiserWeights[i]), _mm256_loadu_ps(taps[i] + j), sum);
+		__m256i values = _mm256_cvtps_epi32(sum);
+		__m128i words = _mm_packus_epi32(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+		_mm_storel_epi64(reinterpret_cast<__m128i *>(dst + j), _mm_packus_epi16(words, words));
+	}
+	kaiserVerticalScalar(dst, taps, j, count);
+}
+
+TPIXEL_AVX2 void downsampleKaiserAvx2(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	downsampleKaiserPasses(dst, src, srcWidth, srcHeight, kaiserHorizontalAvx2, kaiserVerticalAvx2);
+}
+
+#endif
+
+const kernelTable scalarKernels = {expandRGBToRGBAScalar, srgbToLinearScalar, premultiplyAlphaScalar, downsampleBoxScalar, downsampleKaiserScalar};
+#ifdef TPIXEL_X86
+// there is no gather before avx2, so below that srgbToLinear stays a table lookup per channel
+const kernelTable sse4Kernels = {expandRGBToRGBASse4, srgbToLinearScalar, premultiplyAlphaSse4, downsampleBoxSse4, downsampleKaiserSse4};
+const kernelTable avx2Kernels = {expandRGBToRGBAAvx2, srgbToLinearAvx2, premultiplyAlphaAvx2, downsampleBoxAvx2, downsampleKaiserAvx2};
+#endif
+
+// detectSimdLevel never goes past scalar without x86, so init and the benchmark only ask for scalar there
+const kernelTable &kernelsFor(tpixel::simdLevel level)
+{
+	switch (level) {
+#ifdef TPIXEL_X86
+	case tpixel::simdLevel::avx2:
+		return avx2Kernels;
+	case tpixel::simdLevel::sse4:
+		return sse4Kernels;
+#endif
+	default:
+		return scalarKernels;
+	}
+}
+
+tpixel::simdLevel currentLevel = tpixel::simdLevel::scalar;
+const kernelTable *kernels = &scalarKernels;
+
+} // namespace
+
+tpixel::simdLevel tpixel::detectSimdLevel()
+{
+#ifdef TPIXEL_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return simdLevel::avx2;
+	if (__builtin_cpu_supports("sse4.1"))
+		return simdLevel::sse4;
+#endif
+	return simdLevel::scalar;
+}
+
+void tpixel::init()
+{
+	simdLevel best = detectSimdLevel();
+	simdLevel level = best;
+	switch (tsettings::settings.simd) {
+	case tsettings::simdMode::automatic:
+		break;
+	case tsettings::simdMode::scalar:
+		level = simdLevel::scalar;
+		break;
+	case tsettings::simdMode::sse4:
+		level = simdLevel::sse4;
+		break;
+	case tsettings::simdMode::avx2:
+		level = simdLevel::avx2;
+		break;
+	}
+	if (level > best)
+		throw std::runtime_error(std::string("CPU does not support ").append(simdLevelName(level)));
+	currentLevel = level;
+	kernels = &kernelsFor(level);
+}
+
+tpixel::simdLevel tpixel::activeSimdLevel() { return currentLevel; }
+
+const char *tpixel::simdLevelName(simdLevel level)
+{
+	switch (level) {
+	case simdLevel::avx2:
+		return "avx2";
+	case simdLevel::sse4:
+		return "sse4";
+	default:
+		return "scalar";
+	}
+}
+
+void tpixel::expandRGBToRGBA(uint8_t *dst, const uint8_t *src, size_t pixelCount) { kernels->expandRGBToRGBA(dst, src, pixelCount); }
+void tpixel::srgbToLinear(float *dst, const uint8_t *src, size_t pixelCount) { kernels->srgbToLinear(dst, src, pixelCount); }
+void tpixel::premultiplyAlpha(uint8_t *dst, const uint8_t *src, size_t pixelCount) { kernels->premultiplyAlpha(dst, src, pixelCount); }
+void tpixel::downsampleBox(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	kernels->downsampleBox(dst, src, srcWidth, srcHeight);
+}
+void tpixel::downsampleKaiser(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight)
+{
+	kernels->downsampleKaiser(dst, src, srcWidth, srcHeight);
+}
+
+namespace {
+
+const uint32_t BENCH_WIDTH = 2048;
+const uint32_t BENCH_HEIGHT = 2048;
+const int BENCH_RUNS = 5;
+
+// best of a few runs, first one also warms up the caches and page faults the output
+template <typename Function> double bestSeconds(Function function)
+{
+	double best = 1e30;
+	for (int run = 0; run < BENCH_RUNS; ++run) {
+		auto start = std::chrono::high_resolution_clock::now();
+		function();
+		auto end = std::chrono::high_resolution_clock::now();
+		best = std::min(best, std::chrono::duration<double>(end - start).count());
+	}
+	return best;
+}
+
+template <typename T> double maxDifference(const std::vector<T> &a, const std::vector<T> &b)
+{
+	double diff = 0.0;
+	for (size_t i = 0; i < a.size(); ++i)
+		diff = std::max(diff, std::abs(static_cast<double>(a[i]) - static_cast<double>(b[i])));
+	return diff;
+}
+
+void printResult(const char *kernel, tpixel::simdLevel level, size_t bytesMoved, double seconds, double difference, double tolerance)
+{
+	std::cout << "  " << kernel << " (" << tpixel::simdLevelName(level) << "): " << bytesMoved / seconds / 1e9 << " GB/s";
+	if (difference > tolerance)
+		std::cout << "  MISMATCH vs scalar, max difference " << difference;
+	std::cout << std::endl;
+}
+
+} // namespace
+
+void tpixel::runBenchmarks()
+{
+	const size_t pixelCount = static_cast<size_t>(BENCH_WIDTH) * BENCH_HEIGHT;
+	const size_t halfCount = static_cast<size_t>(halfSize(BENCH_WIDTH)) * halfSize(BENCH_HEIGHT);
+
+	// same noise every run so the numbers are comparable
+	std::vector<uint8_t> rgb(pixelCount * 3);
+	std::vector<uint8_t> rgba(pixelCount * 4);
+	uint32_t state = 0x12345678;
+	for (auto &v : rgb) {
+		state = state * 1664525u + 1013904223u;
+		v = static_cast<uint8_t>(state >> 24);
+	}
+	for (auto &v : rgba) {
+		state = state * 1664525u + 1013904223u;
+		v = static_cast<uint8_t>(state >> 24);
+	}
+
+	std::vector<uint8_t> expandReference(pixelCount * 4);
+	std::vector<float> linearReference(pixelCount * 4);
+	std::vector<uint8_t> premultiplyReference(pixelCount * 4);
+	std::vector<uint8_t> boxReference(halfCount * 4);
+	std::vector<uint8_t> kaiserReference(halfCount * 4);
+	scalarKernels.expandRGBToRGBA(expandReference.data(), rgb.data(), pixelCount);
+	scalarKernels.srgbToLinear(linearReference.data(), rgba.data(), pixelCount);
+	scalarKernels.premultiplyAlpha(premultiplyReference.data(), rgba.data(), pixelCount);
+	scalarKernels.downsampleBox(boxReference.data(), rgba.data(), BENCH_WIDTH, BENCH_HEIGHT);
+	scalarKernels.downsampleKaiser(kaiserReference.data(), rgba.data(), BENCH_WIDTH, BENCH_HEIGHT);
+
+	std::vector<uint8_t> bytesOut(pixelCount * 4);
+	std::vector<float> floatsOut(pixelCount * 4);
+	std::vector<uint8_t> halfOut(halfCount * 4);
+
+	std::cout << "pixel kernels on " << BENCH_WIDTH << "x" << BENCH_HEIGHT << ", GB/s counts bytes read + written" << std::endl;
+	simdLevel best = detectSimdLevel();
+	for (simdLevel level : {simdLevel::scalar, simdLevel::sse4, simdLevel::avx2}) {
+		if (level > best)
+			break;
+		const kernelTable &table = kernelsFor(level);
+		double seconds;
+
+		seconds = bestSeconds([&] { table.expandRGBToRGBA(bytesOut.data(), rgb.data(), pixelCount); });
+		printResult("expandRGBToRGBA", level, pixelCount * 7, seconds, maxDifference(bytesOut, expandReference), 0.0);
+
+		seconds = bestSeconds([&] { table.srgbToLinear(floatsOut.data(), rgba.data(), pixelCount); });
+		printResult("srgbToLinear", level, pixelCount * (4 + 16), seconds, maxDifference(floatsOut, linearReference), 0.0);
+
+		seconds = bestSeconds([&] { table.premultiplyAlpha(bytesOut.data(), rgba.data(), pixelCount); });
+		printResult("premultiplyAlpha", level, pixelCount * 8, seconds, maxDifference(bytesOut, premultiplyReference), 0.0);
+
+		seconds = bestSeconds([&] { table.downsampleBox(halfOut.data(), rgba.data(), BENCH_WIDTH, BENCH_HEIGHT); });
+		printResult("downsampleBox", level, (pixelCount + halfCount) * 4, seconds, maxDifference(halfOut, boxReference), 0.0);
+
+		// fma and a different summation order can move a value across a rounding boundary
+		seconds = bestSeconds([&] { table.downsampleKaiser(halfOut.data(), rgba.data(), BENCH_WIDTH, BENCH_HEIGHT); });
+		printResult("downsampleKaiser", level, (pixelCount + halfCount) * 4, seconds, maxDifference(halfOut, kaiserReference), 1.0);
+	}
+}
@@ -0,0 +1,38 @@
+#ifndef TRIANGLE_PIXEL_CONVERSION_HEADER
+#define TRIANGLE_PIXEL_CONVERSION_HEADER
+
+#include <cstddef>
+#include <cstdint>
+
+// cpu side pixel kernels for getting textures into staging memory.
+// every kernel has a scalar version plus whatever sse4/avx2 versions make sense, the best one the cpu
+// supports is picked at runtime (or forced with --simd). all of them only do plain sequential stores
+// so dst can point straight into mapped (possibly write combined) staging memory.
+namespace tpixel {
+
+enum class simdLevel { scalar, sse4, avx2 };
+
+// best level the cpu we are running on can do
+simdLevel detectSimdLevel();
+// picks the kernels from tsettings, throws if the cpu cant do the requested level
+void init();
+simdLevel activeSimdLevel();
+const char *simdLevelName(simdLevel level);
+
+// rgb8 -> rgba8, alpha is set to 255
+void expandRGBToRGBA(uint8_t *dst, const uint8_t *src, size_t pixelCount);
+// srgb encoded rgba8 -> linear rgba32f, alpha is only normalized
+void srgbToLinear(float *dst, const uint8_t *src, size_t pixelCount);
+// rgba8 -> rgba8 with the color channels multiplied by alpha, dst may equal src
+void premultiplyAlpha(uint8_t *dst, const uint8_t *src, size_t pixelCount);
+// rgba8 downsample by 2, dst has to hold max(srcWidth / 2, 1) * max(srcHeight / 2, 1) pixels
+void downsampleBox(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight);
+// same as above but with a kaiser windowed sinc (8 taps) instead of a 2x2 average, sharper mips
+void downsampleKaiser(uint8_t *dst, const uint8_t *src, uint32_t srcWidth, uint32_t srcHeight);
+
+// times every kernel at every level the cpu supports and prints GB/s, checks the results against scalar too
+void runBenchmarks();
+
+} // namespace tpixel
+
+#endif
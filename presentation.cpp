@@ -8,6 +8,7 @@
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 #include "presentation.hpp"
+#include "profiler.hpp"
 #include <cstddef>
 #include <cstdint>
 #include <stdexcept>
@@ -44,7 +45,7 @@ VkPresentModeKHR trianglePresentation::chooseSwapPresentMode(const std::vector<V
 	}
 }
 
-VkExtent2D trianglePresentation::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow* window)
+VkExtent2D trianglePresentation::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, VkExtent2D framebufferSize)
 {
 	//current extent will be correct in many cases, if not it will be set to the max value of uint32
 	// it could be incorrect if screen coordinates (used by glfw) differ from pixels or if the window manager gives us leeway to put any value between two bounds
@@ -52,15 +53,8 @@ VkExtent2D trianglePresentation::chooseSwapExtent(const VkSurfaceCapabilitiesKHR
 	if (capabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()){
 		return capabilities.currentExtent;
 	} else {
-		//pick w/h
-		int width;
-		int height;
-		glfwGetFramebufferSize(window, &width, &height);
-		//im following the tutorial here but wtf if i want to resize my window?
-		VkExtent2D actual = {
-			static_cast<uint32_t>(width),
-			static_cast<uint32_t>(height)
-		};
+		//pick w/h. the size comes from the caller since glfw only answers on the main thread and this runs on the render thread
+		VkExtent2D actual = framebufferSize;
 		//ensure it is between the min and max capable values
 		actual.width = std::clamp(actual.width, capabilities.minImageExtent.width, capabilities.maxImageExtent.width);
 		actual.height = std::clamp(actual.height, capabilities.minImageExtent.height, capabilities.maxImageExtent.height);
@@ -68,14 +62,17 @@ VkExtent2D trianglePresentation::chooseSwapExtent(const VkSurfaceCapabilitiesKHR
 	}
 }
 
-void trianglePresentation::createSwapchain(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkSurfaceKHR surface, GLFWwindow* window, swapchainInformation& handle_swapchainInfo)
+void trianglePresentation::createSwapchain(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkSurfaceKHR surface, VkExtent2D framebufferSize, uint32_t requestedImageCount,
+				     VkSwapchainKHR oldSwapchain, swapchainInformation& handle_swapchainInfo)
 {
 	auto support = trequirement::querySwapChainSupport(physicalDevice, surface);
 	auto format = chooseSwapSurfaceFormat(support.formats);
 	auto presentMode = chooseSwapPresentMode(support.presentModes);
-	auto extent = chooseSwapExtent(support.capabilities, window);
+	auto extent = chooseSwapExtent(support.capabilities, framebufferSize);
 
 	uint32_t imageCount = support.capabilities.minImageCount + 1;
+	if (requestedImageCount != 0)
+		imageCount = std::max(requestedImageCount, support.capabilities.minImageCount);
 	if (support.capabilities.maxImageCount > 0 && imageCount > support.capabilities.maxImageCount)
 		imageCount = support.capabilities.maxImageCount;
 
@@ -107,9 +104,9 @@ void trianglePresentation::createSwapchain(VkPhysicalDevice physicalDevice, VkDe
 	createInfo.presentMode = presentMode;
 	createInfo.clipped = VK_TRUE;
 
-	createInfo.oldSwapchain = VK_NULL_HANDLE;
+	createInfo.oldSwapchain = oldSwapchain;
 
-	if (vkCreateSwapchainKHR(logicalDevice, &createInfo, nullptr, &handle_swapchainInfo.swapchain) != VK_SUCCESS) {
+	if (tprofile::timed("vkCreateSwapchainKHR", vkCreateSwapchainKHR, logicalDevice, &createInfo, nullptr, &handle_swapchainInfo.swapchain) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to create swap chain");
 	}
 	vkGetSwapchainImagesKHR(logicalDevice, handle_swapchainInfo.swapchain, &imageCount, nullptr);
@@ -20,9 +20,13 @@ namespace trianglePresentation{
 	void createSurface(const VkInstance& instance, GLFWwindow *window, VkSurfaceKHR *surface);
 	VkSurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
 	VkPresentModeKHR chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availableModes);
-	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, GLFWwindow* window);
+	//framebufferSize is the window size in pixels, only used when the surface leaves the extent up to us
+	VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities, VkExtent2D framebufferSize);
 
-	void createSwapchain(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkSurfaceKHR surface, GLFWwindow* window, swapchainInformation& handle_swapchainInfo);
+	//requestedImageCount 0 = minImageCount + 1, anything else gets clamped to what the surface supports.
+	//oldSwapchain is handed to the driver so it can reuse its resources, it gets retired but still has to be destroyed by the caller
+	void createSwapchain(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkSurfaceKHR surface, VkExtent2D framebufferSize, uint32_t requestedImageCount,
+			     VkSwapchainKHR oldSwapchain, swapchainInformation& handle_swapchainInfo);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "profiler.hpp"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct total {
+	tprofile::kind what;
+	uint32_t calls = 0;
+	double seconds = 0.0;
+	double fileIoSeconds = 0.0;
+	double gpuWaitSeconds = 0.0;
+};
+
+struct row {
+	std::string name;
+	total t;
+	double cpuSeconds;
+};
+
+std::atomic<bool> recording{false};
+std::mutex totalsMutex;
+std::map<std::string, total> totals;
+std::chrono::steady_clock::time_point startTime, stopTime;
+thread_local tprofile::Scope *innermost = nullptr;
+
+const char *kindName(tprofile::kind what)
+{
+	switch (what) {
+	case tprofile::kind::stage:
+		return "stage";
+	case tprofile::kind::vulkanCall:
+		return "vulkan call";
+	case tprofile::kind::fileIo:
+		return "file io";
+	case tprofile::kind::gpuWait:
+		return "gpu wait";
+	}
+	return "?";
+}
+
+std::vector<row> sortedRows()
+{
+	std::lock_guard<std::mutex> lock(totalsMutex);
+	std::vector<row> rows;
+	for (auto &entry : totals) {
+		const total &t = entry.second;
+		double cpu = t.what == tprofile::kind::fileIo || t.what == tprofile::kind::gpuWait ? 0.0 : t.seconds - t.fileIoSeconds - t.gpuWaitSeconds;
+		rows.push_back({entry.first, t, std::max(cpu, 0.0)});
+	}
+	std::sort(rows.begin(), rows.end(), [](const row &a, const row &b) { return a.t.seconds > b.t.seconds; });
+	return rows;
+}
+
+std::string jsonString(const std::string &value)
+{
+	std::string quoted = "\"";
+	for (char c : value) {
+		if (c == '"' || c == '\\')
+			quoted += '\\';
+		quoted += c;
+	}
+	return quoted + "\"";
+}
+
+} // namespace
+
+tprofile::Scope::Scope(const char *name, kind what) : name(name), what(what), enabled(recording.load(std::memory_order_relaxed))
+{
+	if (!enabled)
+		return;
+	parent = innermost;
+	innermost = this;
+	begin = std::chrono::steady_clock::now();
+}
+
+tprofile::Scope::~Scope()
+{
+	if (!enabled)
+		return;
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	innermost = parent;
+	if (what == kind::fileIo || what == kind::gpuWait) {
+		for (Scope *outer = parent; outer != nullptr; outer = outer->parent) {
+			(what == kind::fileIo ? outer->fileIoSeconds : outer->gpuWaitSeconds) += seconds;
+		}
+	}
+	std::lock_guard<std::mutex> lock(totalsMutex);
+	total &t = totals[name];
+	t.what = what;
+	++t.calls;
+	t.seconds += seconds;
+	t.fileIoSeconds += what == kind::fileIo ? seconds : fileIoSeconds;
+	t.gpuWaitSeconds += what == kind::gpuWait ? seconds : gpuWaitSeconds;
+}
+
+void tprofile::start()
+{
+	startTime = std::chrono::steady_clock::now();
+	recording = true;
+}
+
+void tprofile::stop()
+{
+	if (recording.exchange(false))
+		stopTime = std::chrono::steady_clock::now();
+}
+
+bool tprofile::active() { return recording.load(std::memory_order_relaxed); }
+
+void tprofile::report(std::ostream &out)
+{
+	std::vector<row> rows = sortedRows();
+	size_t nameWidth = 4;
+	for (auto &r : rows) {
+		nameWidth = std::max(nameWidth, r.name.size());
+	}
+	// stages nest, so the totals add up to more than the wall time
+	out << "startup profile, " << std::fixed << std::setprecision(2) << std::chrono::duration<double, std::milli>(stopTime - startTime).count()
+	    << " ms wall" << std::endl;
+	out << std::left << std::setw(static_cast<int>(nameWidth)) << "name" << std::right << std::setw(13) << "kind" << std::setw(7) << "calls"
+	    << std::setw(11) << "total ms" << std::setw(11) << "cpu ms" << std::setw(11) << "gpu ms" << std::setw(11) << "io ms" << std::endl;
+	for (auto &r : rows) {
+		out << std::left << std::setw(static_cast<int>(nameWidth)) << r.name << std::right << std::setw(13) << kindName(r.t.what) << std::setw(7)
+		    << r.t.calls << std::setw(11) << r.t.seconds * 1e3 << std::setw(11) << r.cpuSeconds * 1e3 << std::setw(11) << r.t.gpuWaitSeconds * 1e3
+		    << std::setw(11) << r.t.fileIoSeconds * 1e3 << std::endl;
+	}
+	out << std::defaultfloat << std::setprecision(6);
+}
+
+void tprofile::writeJson(const std::string &path)
+{
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error(std::string("failed to open ").append(path));
+	}
+	std::vector<row> rows = sortedRows();
+	file << "{\n  \"wallMs\": " << std::chrono::duration<double, std::milli>(stopTime - startTime).count() << ",\n  \"entries\": [";
+	for (size_t i = 0; i < rows.size(); ++i) {
+		const row &r = rows[i];
+		file << (i == 0 ? "\n" : ",\n") << "    {\"name\": " << jsonString(r.name) << ", \"kind\": " << jsonString(kindName(r.t.what))
+		     << ", \"calls\": " << r.t.calls << ", \"totalMs\": " << r.t.seconds * 1e3 << ", \"cpuMs\": " << r.cpuSeconds * 1e3
+		     << ", \"gpuWaitMs\": " << r.t.gpuWaitSeconds * 1e3 << ", \"fileIoMs\": " << r.t.fileIoSeconds * 1e3 << "}";
+	}
+	file << "\n  ]\n}\n";
+}
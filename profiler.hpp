@@ -0,0 +1,59 @@
+#ifndef TRIANGLE_PROFILER_HEADER
+#define TRIANGLE_PROFILER_HEADER
+
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <utility>
+
+// scoped timers for finding where startup time goes. every scope adds its time to a per name total, file io and gpu
+// waits also get subtracted from every stage open around them on the same thread, so each stage splits into cpu,
+// blocked on the gpu and file io. recording is off unless start was called and stops for good at stop, the scopes
+// are a single flag check the rest of the time. a stage that waits on the job system may run other tasks inside it,
+// their io and gpu waits land on that stage too
+namespace tprofile {
+
+enum class kind {
+	stage,	    // a step of startup, broken down into the kinds below
+	vulkanCall, // one vkCreate* or allocation, counted as cpu time
+	fileIo,
+	gpuWait
+};
+
+class Scope {
+      public:
+	Scope(const char *name, kind what);
+	~Scope();
+	Scope(const Scope &) = delete;
+	Scope &operator=(const Scope &) = delete;
+
+	// time spent in file io and gpu wait scopes nested inside this one, only tracked for stages
+	double fileIoSeconds = 0.0;
+	double gpuWaitSeconds = 0.0;
+
+      private:
+	const char *name;
+	kind what;
+	bool enabled;
+	Scope *parent; // next scope out on this thread
+	std::chrono::steady_clock::time_point begin;
+};
+
+// times one call, for wrapping vkCreate* calls in place: timed("vkCreateImage", vkCreateImage, device, &info, nullptr, &image)
+template <typename Function, typename... Args> auto timed(const char *name, Function function, Args &&...args)
+{
+	Scope scope(name, kind::vulkanCall);
+	return function(std::forward<Args>(args)...);
+}
+
+void start();
+void stop();
+bool active();
+
+// every name sorted by total time, wall time is from start to stop
+void report(std::ostream &out);
+void writeJson(const std::string &path);
+
+} // namespace tprofile
+
+#endif
@@ -0,0 +1,601 @@
+#include "renderGraph.hpp"
+#include "debugshit.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+static bool useSync2 = false;
+static PFN_vkCmdPipelineBarrier2KHR pipelineBarrier2 = nullptr;
+
+// the bits that actually have to be made available, attachment and storage accesses come with their read bits too
+static const VkAccessFlags2KHR writeAccessBits = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+						 VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT |
+						 VK_ACCESS_2_MEMORY_WRITE_BIT;
+
+tgraph::accessInfo tgraph::describeAccess(access use)
+{
+	// only stage and access bits that exist in vulkan 1.0 too, those have the same values in both versions so the
+	// legacy path can just truncate them
+	switch (use) {
+	case access::none:
+		return {0, 0, VK_IMAGE_LAYOUT_UNDEFINED, false};
+	case access::acquired:
+		return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, 0, VK_IMAGE_LAYOUT_UNDEFINED, false};
+	case access::present:
+		return {VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, 0, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, false};
+	case access::transferRead:
+		return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, false};
+	case access::transferWrite:
+		return {VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, true};
+	case access::computeStorageReadWrite:
+		return {VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_SHADER_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL, true};
+	case access::fragmentSampledRead:
+		return {VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, false};
+	case access::colorAttachmentWrite:
+		return {VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, true};
+	case access::depthAttachmentWrite:
+		return {VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+			true};
+	case access::vertexBufferRead:
+		return {VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false};
+	case access::indexBufferRead:
+		return {VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED, false};
+	case access::uniformRead:
+		return {VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_UNIFORM_READ_BIT, VK_IMAGE_LAYOUT_UNDEFINED,
+			false};
+	}
+	throw std::invalid_argument("unknown render graph access");
+}
+
+void tgraph::init(VkDevice device, bool synchronization2)
+{
+	useSync2 = synchronization2;
+	if (!useSync2)
+		return;
+	pipelineBarrier2 = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(device, "vkCmdPipelineBarrier2KHR");
+	if (pipelineBarrier2 == nullptr) {
+		throw std::runtime_error("Failed to load vkCmdPipelineBarrier2KHR");
+	}
+}
+
+bool tgraph::usingSynchronization2() { return useSync2; }
+
+// the 1.0 barrier wants a stage on both sides, where sync2 would say NONE
+static VkPipelineStageFlags legacySrcStages(VkPipelineStageFlags2KHR stages)
+{
+	return stages ? static_cast<VkPipelineStageFlags>(stages) : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
+}
+
+static VkPipelineStageFlags legacyDstStages(VkPipelineStageFlags2KHR stages)
+{
+	return stages ? static_cast<VkPipelineStageFlags>(stages) : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+}
+
+void tgraph::imageBarrier(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange &range, access previous, access next)
+{
+	accessInfo src = describeAccess(previous);
+	accessInfo dst = describeAccess(next);
+	// only writes have to be made available, a read before a write just needs the execution dependency
+	VkAccessFlags2KHR srcAccess = src.accessMask & writeAccessBits;
+
+	if (useSync2) {
+		VkImageMemoryBarrier2KHR barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+		barrier.srcStageMask = src.stages;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dst.stages;
+		barrier.dstAccessMask = dst.accessMask;
+		barrier.oldLayout = src.layout;
+		barrier.newLayout = dst.layout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange = range;
+		VkDependencyInfoKHR dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependencyInfo.imageMemoryBarrierCount = 1;
+		dependencyInfo.pImageMemoryBarriers = &barrier;
+		pipelineBarrier2(commandBuffer, &dependencyInfo);
+		return;
+	}
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = static_cast<VkAccessFlags>(srcAccess);
+	barrier.dstAccessMask = static_cast<VkAccessFlags>(dst.accessMask);
+	barrier.oldLayout = src.layout;
+	barrier.newLayout = dst.layout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange = range;
+	vkCmdPipelineBarrier(commandBuffer, legacySrcStages(src.stages), legacyDstStages(dst.stages), 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+tgraph::resourceHandle tgraph::RenderGraph::importImage(const std::string &name, VkImageAspectFlags aspect, access initial, access final)
+{
+	if (compiled)
+		throw std::runtime_error("render graph already compiled, cant import " + name);
+	resource imported{};
+	imported.name = name;
+	imported.isImage = true;
+	imported.imported = true;
+	imported.aspect = aspect;
+	imported.initial = initial;
+	imported.final = final;
+	resources.push_back(imported);
+	return static_cast<resourceHandle>(resources.size() - 1);
+}
+
+tgraph::resourceHandle tgraph::RenderGraph::importBuffer(const std::string &name)
+{
+	if (compiled)
+		throw std::runtime_error("render graph already compiled, cant import " + name);
+	resource imported{};
+	imported.name = name;
+	imported.isImage = false;
+	imported.imported = true;
+	imported.initial = access::none;
+	imported.final = access::none;
+	resources.push_back(imported);
+	return static_cast<resourceHandle>(resources.size() - 1);
+}
+
+tgraph::resourceHandle tgraph::RenderGraph::createImage(const std::string &name, const transientImageInfo &info)
+{
+	if (compiled)
+		throw std::runtime_error("render graph already compiled, cant create " + name);
+	resource transient{};
+	transient.name = name;
+	transient.isImage = true;
+	transient.imported = false;
+	transient.aspect = info.aspect;
+	transient.initial = access::none;
+	transient.final = access::none;
+	transient.info = info;
+	resources.push_back(transient);
+	return static_cast<resourceHandle>(resources.size() - 1);
+}
+
+void tgraph::RenderGraph::addPass(const std::string &name, std::vector<resourceUse> uses, std::function<void(VkCommandBuffer)> record, bool sideEffects)
+{
+	if (compiled)
+		throw std::runtime_error("render graph already compiled, cant add pass " + name);
+	for (size_t i = 0; i < uses.size(); ++i) {
+		if (uses[i].resource >= resources.size())
+			throw std::invalid_argument("pass " + name + " uses a resource from another graph");
+		for (size_t j = 0; j < i; ++j) {
+			if (uses[i].resource == uses[j].resource)
+				throw std::invalid_argument("pass " + name + " uses " + resources[uses[i].resource].name + " twice");
+		}
+	}
+	passes.push_back({name, std::move(uses), std::move(record), sideEffects});
+}
+
+// storage accesses read whatever was there, every other write replaces the contents completely
+static bool readsPreviousContents(tgraph::access use)
+{
+	return !tgraph::describeAccess(use).write || use == tgraph::access::computeStorageReadWrite;
+}
+
+void tgraph::RenderGraph::cullPasses(std::vector<bool> &kept) const
+{
+	// walk backwards keeping track of which resources still have a reader coming up, imported ones are read by whoever
+	// gets them afterwards. a pass survives if it writes something that is read later or has side effects
+	std::vector<bool> needed(resources.size(), false);
+	for (size_t i = 0; i < resources.size(); ++i) {
+		needed[i] = resources[i].imported && resources[i].final != access::none;
+	}
+	kept.assign(passes.size(), false);
+	for (size_t p = passes.size(); p-- > 0;) {
+		const pass &candidate = passes[p];
+		bool keep = candidate.sideEffects;
+		for (const auto &use : candidate.uses) {
+			if (describeAccess(use.use).write && needed[use.resource])
+				keep = true;
+		}
+		if (!keep)
+			continue;
+		kept[p] = true;
+		for (const auto &use : candidate.uses) {
+			if (describeAccess(use.use).write)
+				needed[use.resource] = false;
+		}
+		for (const auto &use : candidate.uses) {
+			if (readsPreviousContents(use.use))
+				needed[use.resource] = true;
+		}
+	}
+}
+
+void tgraph::RenderGraph::allocateTransients(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties, const std::vector<bool> &kept,
+					     std::vector<resourceHandle> &previousOccupant)
+{
+	// lifetime of every transient in kept pass indices, images nothing uses are never created
+	const uint32_t unused = UINT32_MAX;
+	std::vector<uint32_t> firstUse(resources.size(), unused), lastUse(resources.size(), 0);
+	for (uint32_t p = 0; p < passes.size(); ++p) {
+		if (!kept[p])
+			continue;
+		for (const auto &use : passes[p].uses) {
+			firstUse[use.resource] = std::min(firstUse[use.resource], p);
+			lastUse[use.resource] = std::max(lastUse[use.resource], p);
+		}
+	}
+
+	std::vector<resourceHandle> order;
+	for (resourceHandle r = 0; r < resources.size(); ++r) {
+		if (!resources[r].imported && firstUse[r] != unused)
+			order.push_back(r);
+	}
+	std::sort(order.begin(), order.end(), [&](resourceHandle a, resourceHandle b) { return firstUse[a] < firstUse[b]; });
+
+	// one memory block per slot, an image can move into a slot once everything already in it is dead
+	struct slot {
+		uint32_t memoryType;
+		VkDeviceSize size;
+		VkDeviceSize alignment;
+		uint32_t lastUse;
+		std::vector<resourceHandle> occupants;
+	};
+	std::vector<slot> slots;
+	std::vector<size_t> slotOf(resources.size());
+	for (resourceHandle r : order) {
+		resource &transient = resources[r];
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.extent = {transient.info.extent.width, transient.info.extent.height, 1};
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.format = transient.info.format;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		imageInfo.usage = transient.info.usage;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.samples = transient.info.samples;
+		if (tprofile::timed("vkCreateImage", vkCreateImage, device, &imageInfo, nullptr, &transient.image) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create render graph image " + transient.name);
+		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE, transient.image, transient.name);
+
+		VkMemoryRequirements memRequirements;
+		vkGetImageMemoryRequirements(device, transient.image, &memRequirements);
+		uint32_t memoryType = UINT32_MAX;
+		for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; ++i) {
+			if ((memRequirements.memoryTypeBits & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) {
+				memoryType = i;
+				break;
+			}
+		}
+		if (memoryType == UINT32_MAX)
+			throw std::runtime_error("No device local memory for render graph image " + transient.name);
+		requestedBytes += memRequirements.size;
+
+		auto reusable = std::find_if(slots.begin(), slots.end(), [&](const slot &s) { return s.memoryType == memoryType && s.lastUse < firstUse[r]; });
+		if (reusable == slots.end()) {
+			slots.push_back({memoryType, 0, 1, 0, {}});
+			reusable = slots.end() - 1;
+		}
+		reusable->size = std::max(reusable->size, memRequirements.size);
+		reusable->alignment = std::max(reusable->alignment, memRequirements.alignment);
+		reusable->lastUse = lastUse[r];
+		reusable->occupants.push_back(r);
+		slotOf[r] = static_cast<size_t>(reusable - slots.begin());
+	}
+
+	for (const slot &s : slots) {
+		VkMemoryAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		allocInfo.allocationSize = s.size;
+		allocInfo.memoryTypeIndex = s.memoryType;
+		VkDeviceMemory memory;
+		if (tprofile::timed("vkAllocateMemory", vkAllocateMemory, device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to allocate render graph memory");
+		}
+		memoryBlocks.push_back(memory);
+		allocatedBytes += s.size;
+
+		// whoever used the memory last has to be done before the next occupant starts, that wraps around to the previous frame
+		for (size_t i = 0; i < s.occupants.size(); ++i) {
+			previousOccupant[s.occupants[i]] = s.occupants[(i + s.occupants.size() - 1) % s.occupants.size()];
+		}
+	}
+
+	for (resourceHandle r : order) {
+		resource &transient = resources[r];
+		vkBindImageMemory(device, transient.image, memoryBlocks[slotOf[r]], 0);
+
+		VkImageViewCreateInfo viewInfo{};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = transient.image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = transient.info.format;
+		// barriers on depth stencil images have to name both aspects, but a view can only show one of them
+		VkImageAspectFlags viewAspect = (transient.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) ? VK_IMAGE_ASPECT_DEPTH_BIT : transient.aspect;
+		viewInfo.subresourceRange = {viewAspect, 0, 1, 0, 1};
+		if (tprofile::timed("vkCreateImageView", vkCreateImageView, device, &viewInfo, nullptr, &transient.view) != VK_SUCCESS) {
+			throw std::runtime_error("Failed to create render graph image view " + transient.name);
+		}
+		DEBUG_NAME(device, VK_OBJECT_TYPE_IMAGE_VIEW, transient.view, transient.name);
+	}
+}
+
+namespace {
+// what has happened to a resource since the last barrier that touched it
+struct resourceState {
+	VkPipelineStageFlags2KHR writeStages = 0;
+	VkAccessFlags2KHR writeAccess = 0;
+	VkPipelineStageFlags2KHR readStages = 0;
+	VkAccessFlags2KHR readAccess = 0;
+	VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+};
+
+resourceState stateAfter(const tgraph::accessInfo &info)
+{
+	resourceState state{};
+	if (info.write) {
+		state.writeStages = info.stages;
+		state.writeAccess = info.accessMask & writeAccessBits;
+	} else {
+		state.readStages = info.stages;
+		state.readAccess = info.accessMask;
+	}
+	state.layout = info.layout;
+	return state;
+}
+
+// moves state on to next and says whether that needs a barrier, filling in its masks and layouts if so.
+// reads after reads in the same layout never need one, and reads that an earlier barrier already covered dont either
+bool transition(resourceState &state, const tgraph::accessInfo &next, bool isImage, VkPipelineStageFlags2KHR &srcStages, VkAccessFlags2KHR &srcAccess,
+		VkImageLayout &oldLayout)
+{
+	bool layoutChange = isImage && next.layout != state.layout;
+	oldLayout = state.layout;
+	if (next.write || layoutChange) {
+		srcStages = state.writeStages | state.readStages;
+		srcAccess = state.writeAccess;
+		bool needed = srcStages != 0 || layoutChange;
+		state = stateAfter(next);
+		// a layout transition counts as a write, later readers in other stages have to come after it
+		if (!next.write)
+			state.writeStages = next.stages;
+		if (!isImage)
+			state.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		return needed;
+	}
+
+	srcStages = state.writeStages;
+	srcAccess = state.writeAccess;
+	bool covered = (state.readStages & next.stages) == next.stages && (state.readAccess & next.accessMask) == next.accessMask;
+	state.readStages |= next.stages;
+	state.readAccess |= next.accessMask;
+	return state.writeStages != 0 && !covered;
+}
+} // namespace
+
+void tgraph::RenderGraph::computeBarriers(const std::vector<bool> &kept, const std::vector<resourceHandle> &previousOccupant)
+{
+	// run through the passes twice, first to find how every transient is left at the end of a frame, then for real with
+	// each transient starting out where the previous user of its memory left off
+	std::vector<resourceState> endStates(resources.size());
+	for (int round = 0; round < 2; ++round) {
+		std::vector<resourceState> states(resources.size());
+		for (resourceHandle r = 0; r < resources.size(); ++r) {
+			if (resources[r].imported) {
+				states[r] = stateAfter(describeAccess(resources[r].initial));
+			} else if (round == 1) {
+				states[r] = endStates[previousOccupant[r]];
+				states[r].layout = VK_IMAGE_LAYOUT_UNDEFINED; // nothing is kept between frames
+			}
+		}
+
+		for (uint32_t p = 0; p < passes.size(); ++p) {
+			if (!kept[p])
+				continue;
+			compiledPass compiledP{p, {}};
+			for (const auto &use : passes[p].uses) {
+				accessInfo next = describeAccess(use.use);
+				barrier b{};
+				b.resource = use.resource;
+				if (transition(states[use.resource], next, resources[use.resource].isImage, b.srcStages, b.srcAccess, b.oldLayout)) {
+					b.dstStages = next.stages;
+					b.dstAccess = next.accessMask;
+					b.newLayout = next.layout;
+					compiledP.barriers.push_back(b);
+				}
+			}
+			if (round == 1)
+				compiledPasses.push_back(std::move(compiledP));
+		}
+
+		if (round == 0) {
+			endStates = states;
+			continue;
+		}
+		for (resourceHandle r = 0; r < resources.size(); ++r) {
+			if (!resources[r].imported || resources[r].final == access::none)
+				continue;
+			accessInfo next = describeAccess(resources[r].final);
+			barrier b{};
+			b.resource = r;
+			if (transition(states[r], next, resources[r].isImage, b.srcStages, b.srcAccess, b.oldLayout)) {
+				b.dstStages = next.stages;
+				b.dstAccess = next.accessMask;
+				b.newLayout = next.layout;
+				finalBarriers.push_back(b);
+			}
+		}
+	}
+}
+
+void tgraph::RenderGraph::compile(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties)
+{
+	if (compiled)
+		throw std::runtime_error("render graph compiled twice");
+	std::vector<bool> kept;
+	cullPasses(kept);
+	std::vector<resourceHandle> previousOccupant(resources.size());
+	allocateTransients(device, memoryProperties, kept, previousOccupant);
+	computeBarriers(kept, previousOccupant);
+	compiled = true;
+}
+
+void tgraph::RenderGraph::destroy(VkDevice device)
+{
+	for (auto &r : resources) {
+		if (r.imported)
+			continue;
+		vkDestroyImageView(device, r.view, nullptr);
+		vkDestroyImage(device, r.image, nullptr);
+	}
+	for (auto memory : memoryBlocks) {
+		vkFreeMemory(device, memory, nullptr);
+	}
+	resources.clear();
+	passes.clear();
+	compiledPasses.clear();
+	finalBarriers.clear();
+	memoryBlocks.clear();
+	requestedBytes = allocatedBytes = 0;
+	compiled = false;
+}
+
+void tgraph::RenderGraph::setImportedImage(resourceHandle resource, VkImage image)
+{
+	if (!resources.at(resource).imported || !resources[resource].isImage)
+		throw std::invalid_argument(resources[resource].name + " is not an imported image");
+	resources[resource].image = image;
+}
+
+void tgraph::RenderGraph::setImportedBuffer(resourceHandle resource, VkBuffer buffer)
+{
+	if (!resources.at(resource).imported || resources[resource].isImage)
+		throw std::invalid_argument(resources[resource].name + " is not an imported buffer");
+	resources[resource].buffer = buffer;
+}
+
+VkImage tgraph::RenderGraph::image(resourceHandle resource) const { return resources.at(resource).image; }
+
+VkImageView tgraph::RenderGraph::imageView(resourceHandle resource) const { return resources.at(resource).view; }
+
+uint32_t tgraph::RenderGraph::barrierCount() const
+{
+	size_t count = finalBarriers.size();
+	for (const auto &p : compiledPasses) {
+		count += p.barriers.size();
+	}
+	return static_cast<uint32_t>(count);
+}
+
+void tgraph::RenderGraph::recordBarriers(VkCommandBuffer commandBuffer, const std::vector<barrier> &barriers) const
+{
+	if (barriers.empty())
+		return;
+
+	// everything a pass needs goes into one barrier call
+	std::vector<VkImageMemoryBarrier2KHR> imageBarriers;
+	std::vector<VkBufferMemoryBarrier2KHR> bufferBarriers;
+	for (const auto &b : barriers) {
+		const resource &r = resources[b.resource];
+		if (r.isImage) {
+			if (r.image == VK_NULL_HANDLE)
+				throw std::runtime_error("render graph image " + r.name + " was never set");
+			VkImageMemoryBarrier2KHR imageBarrier{};
+			imageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+			imageBarrier.srcStageMask = b.srcStages;
+			imageBarrier.srcAccessMask = b.srcAccess;
+			imageBarrier.dstStageMask = b.dstStages;
+			imageBarrier.dstAccessMask = b.dstAccess;
+			imageBarrier.oldLayout = b.oldLayout;
+			imageBarrier.newLayout = b.newLayout;
+			imageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			imageBarrier.image = r.image;
+			imageBarrier.subresourceRange = {r.aspect, 0, VK_REMAINING_MIP_LEVELS, 0, VK_REMAINING_ARRAY_LAYERS};
+			imageBarriers.push_back(imageBarrier);
+		} else {
+			if (r.buffer == VK_NULL_HANDLE)
+				throw std::runtime_error("render graph buffer " + r.name + " was never set");
+			VkBufferMemoryBarrier2KHR bufferBarrier{};
+			bufferBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2_KHR;
+			bufferBarrier.srcStageMask = b.srcStages;
+			bufferBarrier.srcAccessMask = b.srcAccess;
+			bufferBarrier.dstStageMask = b.dstStages;
+			bufferBarrier.dstAccessMask = b.dstAccess;
+			bufferBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			bufferBarrier.buffer = r.buffer;
+			bufferBarrier.offset = 0;
+			bufferBarrier.size = VK_WHOLE_SIZE;
+			bufferBarriers.push_back(bufferBarrier);
+		}
+	}
+
+	if (useSync2) {
+		VkDependencyInfoKHR dependencyInfo{};
+		dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(bufferBarriers.size());
+		dependencyInfo.pBufferMemoryBarriers = bufferBarriers.data();
+		dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size());
+		dependencyInfo.pImageMemoryBarriers = imageBarriers.data();
+		pipelineBarrier2(commandBuffer, &dependencyInfo);
+		return;
+	}
+
+	// the 1.0 call only has one pair of stage masks for all of them
+	VkPipelineStageFlags2KHR srcStages = 0, dstStages = 0;
+	std::vector<VkImageMemoryBarrier> legacyImageBarriers;
+	std::vector<VkBufferMemoryBarrier> legacyBufferBarriers;
+	for (const auto &b : imageBarriers) {
+		srcStages |= b.srcStageMask;
+		dstStages |= b.dstStageMask;
+		VkImageMemoryBarrier legacy{};
+		legacy.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		legacy.srcAccessMask = static_cast<VkAccessFlags>(b.srcAccessMask);
+		legacy.dstAccessMask = static_cast<VkAccessFlags>(b.dstAccessMask);
+		legacy.oldLayout = b.oldLayout;
+		legacy.newLayout = b.newLayout;
+		legacy.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		legacy.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		legacy.image = b.image;
+		legacy.subresourceRange = b.subresourceRange;
+		legacyImageBarriers.push_back(legacy);
+	}
+	for (const auto &b : bufferBarriers) {
+		srcStages |= b.srcStageMask;
+		dstStages |= b.dstStageMask;
+		VkBufferMemoryBarrier legacy{};
+		legacy.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		legacy.srcAccessMask = static_cast<VkAccessFlags>(b.srcAccessMask);
+		legacy.dstAccessMask = static_cast<VkAccessFlags>(b.dstAccessMask);
+		legacy.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		legacy.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		legacy.buffer = b.buffer;
+		legacy.offset = b.offset;
+		legacy.size = b.size;
+		legacyBufferBarriers.push_back(legacy);
+	}
+	vkCmdPipelineBarrier(commandBuffer, legacySrcStages(srcStages), legacyDstStages(dstStages), 0, 0, nullptr,
+			     static_cast<uint32_t>(legacyBufferBarriers.size()), legacyBufferBarriers.data(), static_cast<uint32_t>(legacyImageBarriers.size()),
+			     legacyImageBarriers.data());
+}
+
+void tgraph::RenderGraph::execute(VkCommandBuffer commandBuffer, const passHooks *hooks) const
+{
+	if (!compiled)
+		throw std::runtime_error("render graph executed before compile");
+	for (const auto &p : compiledPasses) {
+		recordBarriers(commandBuffer, p.barriers);
+		const pass &recorded = passes[p.pass];
+		DEBUG_LABEL(commandBuffer, recorded.name);
+		if (hooks && hooks->before)
+			hooks->before(commandBuffer, recorded.name);
+		recorded.record(commandBuffer);
+		if (hooks && hooks->after)
+			hooks->after(commandBuffer, recorded.name);
+	}
+	recordBarriers(commandBuffer, finalBarriers);
+}
@@ -0,0 +1,148 @@
+#ifndef TRIANGLE_RENDER_GRAPH_HEADER
+#define TRIANGLE_RENDER_GRAPH_HEADER
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+// frame graph: passes say which images and buffers they touch and how, the graph works out the barriers and layout
+// transitions between them, drops passes nobody needs the output of and lets transient images whose lifetimes dont
+// overlap share memory. passes record their own commands (render pass begin and all), the graph only does the sync
+namespace tgraph {
+
+// every way something in here reads or writes a resource. each one maps to fixed stages, access bits and layout
+enum class access {
+	none,			 // contents dont matter, nothing to wait for
+	acquired,		 // swapchain image right after acquire, ordered by the acquire semaphore wait at color output
+	present,		 // handed to the presentation engine
+	transferRead,
+	transferWrite,
+	computeStorageReadWrite, // storage image in GENERAL or storage buffer
+	fragmentSampledRead,
+	colorAttachmentWrite, // also what resolve attachments are
+	depthAttachmentWrite,
+	vertexBufferRead,
+	indexBufferRead,
+	uniformRead // vertex and fragment shaders
+};
+
+struct accessInfo {
+	VkPipelineStageFlags2KHR stages;
+	VkAccessFlags2KHR accessMask;
+	VkImageLayout layout;
+	bool write;
+};
+accessInfo describeAccess(access use);
+
+// picks vkCmdPipelineBarrier2KHR or the 1.0 barrier for everything recorded through this namespace.
+// call once after creating the device, synchronization2 only if the extension was enabled on it
+void init(VkDevice device, bool synchronization2);
+bool usingSynchronization2();
+
+// one off barrier for code outside a graph (uploads, mip generation), previous is how the range was last used
+void imageBarrier(VkCommandBuffer commandBuffer, VkImage image, const VkImageSubresourceRange &range, access previous, access next);
+
+using resourceHandle = uint32_t;
+
+// run around every pass execute records, after the barriers in front of it. for gpu timestamps and the like
+struct passHooks {
+	std::function<void(VkCommandBuffer, const std::string &)> before;
+	std::function<void(VkCommandBuffer, const std::string &)> after;
+};
+
+// what the graph needs to create a transient image, extent is the full size and it always has one mip and layer
+struct transientImageInfo {
+	VkFormat format;
+	VkExtent2D extent;
+	VkSampleCountFlagBits samples;
+	VkImageUsageFlags usage;
+	VkImageAspectFlags aspect; // every aspect the format has, the view only gets depth for depth stencil formats
+};
+
+struct resourceUse {
+	resourceHandle resource;
+	access use;
+};
+
+class RenderGraph {
+      public:
+	// owned by someone else and set for every execute, initial and final are how it is used before and after the graph
+	resourceHandle importImage(const std::string &name, VkImageAspectFlags aspect, access initial, access final);
+	resourceHandle importBuffer(const std::string &name);
+	// created by compile and only valid within one execution, the contents never survive from one frame to the next
+	resourceHandle createImage(const std::string &name, const transientImageInfo &info);
+	// sideEffects keeps the pass even if nothing reads what it writes
+	void addPass(const std::string &name, std::vector<resourceUse> uses, std::function<void(VkCommandBuffer)> record, bool sideEffects = false);
+
+	// culls passes, works out the barriers and creates the transient images. nothing can be added after this
+	void compile(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties);
+	// releases the transient images, the graph is empty again afterwards and can be built from scratch
+	void destroy(VkDevice device);
+
+	void setImportedImage(resourceHandle resource, VkImage image);
+	void setImportedBuffer(resourceHandle resource, VkBuffer buffer);
+	VkImage image(resourceHandle resource) const;
+	VkImageView imageView(resourceHandle resource) const;
+
+	// records every pass that survived culling with its barriers in front of it
+	void execute(VkCommandBuffer commandBuffer, const passHooks *hooks = nullptr) const;
+
+	// what compile did, for printing
+	uint32_t keptPassCount() const { return static_cast<uint32_t>(compiledPasses.size()); }
+	uint32_t culledPassCount() const { return static_cast<uint32_t>(passes.size() - compiledPasses.size()); }
+	uint32_t barrierCount() const;
+	VkDeviceSize transientBytes() const { return allocatedBytes; }
+	VkDeviceSize aliasedBytes() const { return requestedBytes - allocatedBytes; }
+
+      private:
+	struct resource {
+		std::string name;
+		bool isImage;
+		bool imported;
+		VkImageAspectFlags aspect;
+		access initial;
+		access final;
+		transientImageInfo info;
+		VkImage image = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		VkBuffer buffer = VK_NULL_HANDLE;
+	};
+	struct pass {
+		std::string name;
+		std::vector<resourceUse> uses;
+		std::function<void(VkCommandBuffer)> record;
+		bool sideEffects;
+	};
+	struct barrier {
+		resourceHandle resource;
+		VkPipelineStageFlags2KHR srcStages, dstStages;
+		VkAccessFlags2KHR srcAccess, dstAccess;
+		VkImageLayout oldLayout, newLayout;
+	};
+	struct compiledPass {
+		uint32_t pass;
+		std::vector<barrier> barriers;
+	};
+
+	void cullPasses(std::vector<bool> &kept) const;
+	void allocateTransients(VkDevice device, const VkPhysicalDeviceMemoryProperties &memoryProperties, const std::vector<bool> &kept,
+				std::vector<resourceHandle> &previousOccupant);
+	void computeBarriers(const std::vector<bool> &kept, const std::vector<resourceHandle> &previousOccupant);
+	void recordBarriers(VkCommandBuffer commandBuffer, const std::vector<barrier> &barriers) const;
+
+	std::vector<resource> resources;
+	std::vector<pass> passes;
+	std::vector<compiledPass> compiledPasses;
+	std::vector<barrier> finalBarriers; // imported resources back to their final access
+	std::vector<VkDeviceMemory> memoryBlocks;
+	VkDeviceSize requestedBytes = 0;
+	VkDeviceSize allocatedBytes = 0;
+	bool compiled = false;
+};
+
+} // namespace tgraph
+
+#endif
@@ -111,6 +111,18 @@ std::vector<const char*> trequirement::getRequiredExtensions()
 	if (enableValidationLayers){
 		extvec.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 	}
+#ifdef TRIANGLE_DEBUG_NAMES_ENABLED
+	// object names and labels dont need the validation layer, only the extension. without it they just do nothing
+	else {
+		uint32_t extensionCount = 0;
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+		std::vector<VkExtensionProperties> available(extensionCount);
+		vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, available.data());
+		if (std::any_of(available.begin(), available.end(),
+				[](const VkExtensionProperties &extension) { return strcmp(extension.extensionName, VK_EXT_DEBUG_UTILS_EXTENSION_NAME) == 0; }))
+			extvec.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
+	}
+#endif
 	return extvec;
 }
 
@@ -0,0 +1,65 @@
+#include "samplerCache.hpp"
+#include "assetRegistry.hpp"
+#include "profiler.hpp"
+#include <cstring>
+#include <stdexcept>
+
+static uint32_t floatBits(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+static tsampler::samplerKey makeKey(const VkSamplerCreateInfo &info)
+{
+	tsampler::samplerKey key{};
+	key.values[0] = info.flags;
+	key.values[1] = info.magFilter;
+	key.values[2] = info.minFilter;
+	key.values[3] = info.mipmapMode;
+	key.values[4] = info.addressModeU;
+	key.values[5] = info.addressModeV;
+	key.values[6] = info.addressModeW;
+	key.values[7] = floatBits(info.mipLodBias);
+	key.values[8] = info.anisotropyEnable;
+	// anisotropy and compare op dont matter when they are disabled, zero them so those samplers still match
+	key.values[9] = info.anisotropyEnable ? floatBits(info.maxAnisotropy) : 0;
+	key.values[10] = info.compareEnable;
+	key.values[11] = info.compareEnable ? info.compareOp : 0;
+	key.values[12] = floatBits(info.minLod);
+	key.values[13] = floatBits(info.maxLod);
+	key.values[14] = info.borderColor;
+	key.values[15] = info.unnormalizedCoordinates;
+	return key;
+}
+
+bool tsampler::samplerKey::operator==(const samplerKey &other) const { return memcmp(values, other.values, sizeof(values)) == 0; }
+
+size_t tsampler::samplerKeyHash::operator()(const samplerKey &key) const { return static_cast<size_t>(tasset::hash64(key.values, sizeof(key.values))); }
+
+VkSampler tsampler::SamplerCache::get(VkDevice device, const VkSamplerCreateInfo &createInfo)
+{
+	if (createInfo.pNext != nullptr) {
+		throw std::invalid_argument("sampler cache cant handle VkSamplerCreateInfo with a pNext chain");
+	}
+	samplerKey key = makeKey(createInfo);
+	auto it = samplers.find(key);
+	if (it != samplers.end())
+		return it->second;
+
+	VkSampler sampler;
+	if (tprofile::timed("vkCreateSampler", vkCreateSampler, device, &createInfo, nullptr, &sampler) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create texture sampler");
+	}
+	samplers.emplace(key, sampler);
+	return sampler;
+}
+
+void tsampler::SamplerCache::destroyAll(VkDevice device)
+{
+	for (auto &entry : samplers) {
+		vkDestroySampler(device, entry.second, nullptr);
+	}
+	samplers.clear();
+}
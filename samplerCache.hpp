@@ -0,0 +1,37 @@
+#ifndef TRIANGLE_SAMPLER_CACHE_HEADER
+#define TRIANGLE_SAMPLER_CACHE_HEADER
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vulkan/vulkan_core.h>
+
+// drivers only allow maxSamplerAllocationCount samplers (can be as low as 4000) and most textures want the same
+// filtering anyway, so samplers are created through here and shared by everything asking for the same create info
+namespace tsampler {
+
+// every field of VkSamplerCreateInfo except sType/pNext, all 4 bytes wide so there is no padding to hash
+struct samplerKey {
+	uint32_t values[16];
+	bool operator==(const samplerKey &other) const;
+};
+
+struct samplerKeyHash {
+	size_t operator()(const samplerKey &key) const;
+};
+
+class SamplerCache {
+      public:
+	// returns the sampler for createInfo, creating it on first use. the cache owns it, dont destroy it yourself.
+	// pNext chains cant be compared generically so createInfo.pNext has to be null
+	VkSampler get(VkDevice device, const VkSamplerCreateInfo &createInfo);
+	void destroyAll(VkDevice device);
+	size_t size() const { return samplers.size(); }
+
+      private:
+	std::unordered_map<samplerKey, VkSampler, samplerKeyHash> samplers;
+};
+
+} // namespace tsampler
+
+#endif
@@ -0,0 +1,217 @@
+#include "settings.hpp"
+#include <stdexcept>
+#include <string>
+
+tsettings::appSettings tsettings::settings;
+
+static tsettings::mipGenMode parseMipGenMode(const std::string &value)
+{
+	if (value == "auto")
+		return tsettings::mipGenMode::automatic;
+	if (value == "blit")
+		return tsettings::mipGenMode::blit;
+	if (value == "compute")
+		return tsettings::mipGenMode::compute;
+	throw std::invalid_argument("--mipgen must be one of auto, blit, compute");
+}
+
+static tsettings::simdMode parseSimdMode(const std::string &value)
+{
+	if (value == "auto")
+		return tsettings::simdMode::automatic;
+	if (value == "scalar")
+		return tsettings::simdMode::scalar;
+	if (value == "sse4")
+		return tsettings::simdMode::sse4;
+	if (value == "avx2")
+		return tsettings::simdMode::avx2;
+	throw std::invalid_argument("--simd must be one of auto, scalar, sse4, avx2");
+}
+
+static tsettings::bindlessMode parseBindlessMode(const std::string &value)
+{
+	if (value == "auto")
+		return tsettings::bindlessMode::automatic;
+	if (value == "on")
+		return tsettings::bindlessMode::on;
+	if (value == "off")
+		return tsettings::bindlessMode::off;
+	throw std::invalid_argument("--bindless must be one of auto, on, off");
+}
+
+static tsettings::transformMode parseTransformMode(const std::string &value)
+{
+	if (value == "push")
+		return tsettings::transformMode::push;
+	if (value == "dynamic")
+		return tsettings::transformMode::dynamic;
+	throw std::invalid_argument("--transforms must be one of push, dynamic");
+}
+
+static tsettings::syncMode parseSyncMode(const std::string &value)
+{
+	if (value == "auto")
+		return tsettings::syncMode::automatic;
+	if (value == "timeline")
+		return tsettings::syncMode::timeline;
+	if (value == "fences")
+		return tsettings::syncMode::fences;
+	throw std::invalid_argument("--sync must be one of auto, timeline, fences");
+}
+
+static tsettings::barrierMode parseBarrierMode(const std::string &value)
+{
+	if (value == "auto")
+		return tsettings::barrierMode::automatic;
+	if (value == "sync2")
+		return tsettings::barrierMode::sync2;
+	if (value == "legacy")
+		return tsettings::barrierMode::legacy;
+	throw std::invalid_argument("--barriers must be one of auto, sync2, legacy");
+}
+
+static tsettings::renderingMode parseRenderingMode(const std::string &value)
+{
+	if (value == "auto")
+		return tsettings::renderingMode::automatic;
+	if (value == "dynamic")
+		return tsettings::renderingMode::dynamic;
+	if (value == "renderpass")
+		return tsettings::renderingMode::renderpass;
+	throw std::invalid_argument("--rendering must be one of auto, dynamic, renderpass");
+}
+
+static tsettings::validationSeverity parseValidationSeverity(const std::string &value)
+{
+	if (value == "verbose")
+		return tsettings::validationSeverity::verbose;
+	if (value == "info")
+		return tsettings::validationSeverity::info;
+	if (value == "warning")
+		return tsettings::validationSeverity::warning;
+	if (value == "error")
+		return tsettings::validationSeverity::error;
+	throw std::invalid_argument("--validation-level must be one of verbose, info, warning, error");
+}
+
+// comma separated, none of them turns messages off completely
+static uint32_t parseValidationTypes(const std::string &value)
+{
+	uint32_t types = 0;
+	size_t start = 0;
+	while (start <= value.size()) {
+		size_t end = value.find(',', start);
+		std::string type = value.substr(start, end == std::string::npos ? std::string::npos : end - start);
+		if (type == "general")
+			types |= tsettings::VALIDATION_GENERAL;
+		else if (type == "validation")
+			types |= tsettings::VALIDATION_SPEC;
+		else if (type == "performance")
+			types |= tsettings::VALIDATION_PERFORMANCE;
+		else if (type == "none" && value == "none")
+			return 0;
+		else
+			throw std::invalid_argument("--validation-types must be none or a list of general, validation, performance");
+		if (end == std::string::npos)
+			break;
+		start = end + 1;
+	}
+	return types;
+}
+
+static uint32_t parseCount(const std::string &name, const std::string &value, unsigned long min, unsigned long max)
+{
+	size_t end = 0;
+	unsigned long count = 0;
+	try {
+		count = std::stoul(value, &end);
+	} catch (const std::exception &) {
+		end = 0;
+	}
+	if (end == 0 || end != value.size() || count < min || count > max)
+		throw std::invalid_argument(name + " must be a number between " + std::to_string(min) + " and " + std::to_string(max));
+	return static_cast<uint32_t>(count);
+}
+
+void tsettings::parseArguments(int argc, char **argv)
+{
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		auto split = arg.find('=');
+		std::string name = arg.substr(0, split);
+		std::string value = split == std::string::npos ? "" : arg.substr(split + 1);
+
+		if (name == "--mipgen") {
+			settings.mipGen = parseMipGenMode(value);
+		} else if (name == "--simd") {
+			settings.simd = parseSimdMode(value);
+		} else if (name == "--bindless") {
+			settings.bindless = parseBindlessMode(value);
+		} else if (name == "--transforms") {
+			settings.transforms = parseTransformMode(value);
+		} else if (name == "--sync") {
+			settings.sync = parseSyncMode(value);
+		} else if (name == "--barriers") {
+			settings.barriers = parseBarrierMode(value);
+		} else if (name == "--rendering") {
+			settings.rendering = parseRenderingMode(value);
+		} else if (name == "--draws") {
+			settings.drawCount = parseCount(name, value, 1, 1000000);
+			settings.reportDrawCost = true;
+		} else if (name == "--cache-commands") {
+			settings.cacheCommands = true;
+		} else if (name == "--record-threads") {
+			settings.recordThreads = parseCount(name, value, 0, 64);
+		} else if (name == "--job-threads") {
+			settings.jobThreads = parseCount(name, value, 0, 256);
+		} else if (name == "--frames-in-flight") {
+			settings.framesInFlight = parseCount(name, value, 1, 8);
+		} else if (name == "--swapchain-images") {
+			settings.swapchainImages = parseCount(name, value, 0, 16);
+		} else if (name == "--low-latency") {
+			settings.lowLatency = true;
+		} else if (name == "--report-latency") {
+			settings.reportLatency = true;
+		} else if (name == "--report-gpu-time") {
+			settings.reportGpuTime = true;
+		} else if (name == "--pipeline-stats") {
+			settings.pipelineStats = true;
+		} else if (name == "--stall-report") {
+			settings.stallReportPath = value.empty() ? "stalls.json" : value;
+		} else if (name == "--validation-level") {
+			settings.validationLevel = parseValidationSeverity(value);
+		} else if (name == "--validation-types") {
+			settings.validationTypes = parseValidationTypes(value);
+		} else if (name == "--api-counters" || name == "--expect-submits" || name == "--expect-allocations") {
+#ifndef TRIANGLE_API_COUNTERS_ENABLED
+			throw std::invalid_argument(name + " needs a build with TRIANGLE_API_COUNTERS on");
+#endif
+			settings.apiCounters = true;
+			if (name == "--expect-submits")
+				settings.expectSubmits = parseCount(name, value, 0, 1000);
+			else if (name == "--expect-allocations")
+				settings.expectAllocations = parseCount(name, value, 0, 1000000);
+		} else if (name == "--single-thread") {
+			settings.renderThread = false;
+		} else if (name == "--event-load") {
+			settings.eventLoadMicros = parseCount(name, value, 0, 1000000);
+		} else if (name == "--serial-startup") {
+			settings.serialStartup = true;
+		} else if (name == "--startup-trace") {
+			settings.startupTrace = true;
+		} else if (name == "--startup-profile") {
+			settings.startupProfilePath = value.empty() ? "startup_profile.json" : value;
+		} else if (name == "--trace") {
+#ifndef TRIANGLE_TRACE_ENABLED
+			throw std::invalid_argument("--trace needs a build with TRIANGLE_TRACE on");
+#endif
+			settings.tracePath = value.empty() ? "trace.json" : value;
+		} else if (name == "--bench-pixels") {
+			settings.benchPixels = true;
+		} else if (name == "--bench-jobs") {
+			settings.benchJobs = true;
+		} else {
+			throw std::invalid_argument(std::string("Unknown argument: ").append(arg));
+		}
+	}
+}
@@ -0,0 +1,103 @@
+#ifndef TRIANGLE_SETTINGS_HEADER
+#define TRIANGLE_SETTINGS_HEADER
+
+#include <cstdint>
+#include <string>
+
+namespace tsettings {
+
+enum class mipGenMode {
+	automatic, // compute when the device can do it, blit otherwise
+	blit,
+	compute
+};
+
+// bindless keeps every texture in one big descriptor array and picks one per draw with a push constant
+enum class bindlessMode {
+	automatic, // bindless when the device has descriptor indexing
+	on,
+	off
+};
+
+// where the vertex shader gets each draws model matrix from
+enum class transformMode {
+	push,	// push constants, nothing to upload
+	dynamic // per draw slot in a uniform buffer ring, selected with a dynamic offset
+};
+
+// how frames and uploads are tracked, timeline uses one counter per queue instead of a fence per frame
+enum class syncMode {
+	automatic, // timeline when the device has VK_KHR_timeline_semaphore
+	timeline,
+	fences
+};
+
+// how the render graph records its barriers
+enum class barrierMode {
+	automatic, // sync2 when the device has VK_KHR_synchronization2
+	sync2,
+	legacy // plain vkCmdPipelineBarrier
+};
+
+// what the scene pass renders with
+enum class renderingMode {
+	automatic, // dynamic when the device has VK_KHR_dynamic_rendering
+	dynamic,   // vkCmdBeginRendering straight into image views
+	renderpass // VkRenderPass + a framebuffer per swapchain image
+};
+
+// which pixel kernels tpixel uses, automatic is the best the cpu supports
+enum class simdMode { automatic, scalar, sse4, avx2 };
+
+// least severe validation message that still gets through
+enum class validationSeverity { verbose, info, warning, error };
+
+// validation message types that get through, any combination of these
+const uint32_t VALIDATION_GENERAL = 1 << 0;
+const uint32_t VALIDATION_SPEC = 1 << 1; // actual validation errors, spec violations
+const uint32_t VALIDATION_PERFORMANCE = 1 << 2;
+
+struct appSettings {
+	mipGenMode mipGen = mipGenMode::automatic;
+	simdMode simd = simdMode::automatic;
+	bindlessMode bindless = bindlessMode::automatic;
+	transformMode transforms = transformMode::push;
+	syncMode sync = syncMode::automatic;
+	barrierMode barriers = barrierMode::automatic;
+	renderingMode rendering = renderingMode::automatic;
+	uint32_t drawCount = 1; // how many copies of the model to draw each frame, for measuring per draw cpu cost
+	bool reportDrawCost = false; // print the per frame cpu cost of transforms + recording, set by --draws
+	bool cacheCommands = false; // record command buffers once per (frame, swapchain image) and reuse them
+	uint32_t recordThreads = 0; // 0 records inline, otherwise draws are split over this many secondary buffers recorded as jobs
+	uint32_t jobThreads = 0; // job system workers including the calling thread, 0 = one per hardware thread
+	uint32_t framesInFlight = 2; // frames the cpu may queue ahead of the gpu, 1 gives the lowest latency
+	uint32_t swapchainImages = 0; // 0 lets createSwapchain pick (minImageCount + 1), otherwise clamped to what the surface allows
+	bool lowLatency = false; // do every blocking wait first and only then sample input and build the frame
+	bool reportLatency = false; // print input to present latency and frame time jitter every so often
+	bool reportGpuTime = false; // print rolling gpu times of every pass and upload every so often
+	bool pipelineStats = false; // count shader invocations and clipped primitives per frame, printed with the frame time
+	std::string stallReportPath; // where the per frame stall analysis goes at exit, empty is no analysis
+	validationSeverity validationLevel = validationSeverity::warning;
+	uint32_t validationTypes = VALIDATION_GENERAL | VALIDATION_SPEC | VALIDATION_PERFORMANCE;
+	bool apiCounters = false; // count vulkan calls per frame, needs a build with TRIANGLE_API_COUNTERS on
+	uint32_t expectSubmits = UINT32_MAX; // submits every steady state frame must make, UINT32_MAX is no check
+	uint32_t expectAllocations = UINT32_MAX; // same for allocations, 0 asserts the frame loop never allocates
+	bool renderThread = true; // draw on a thread of its own so event handling and blocking vulkan calls dont stall each other
+	uint32_t eventLoadMicros = 0; // busy wait this long after every event poll, fakes a slow event loop for measuring
+	bool serialStartup = false; // run the startup tasks one after another instead of as a graph, for comparing
+	bool startupTrace = false; // print the startup timeline with its critical path
+	std::string startupProfilePath; // where to write the startup profile as json, empty is no profiling
+	std::string tracePath; // where F12 and exit write the cpu trace, empty is no tracing
+	bool benchPixels = false; // run the pixel kernel benchmarks and exit, no window
+	bool benchJobs = false; // run the job system benchmarks and exit, no window
+};
+
+// filled in by parseArguments before the app starts, read only after that
+extern appSettings settings;
+
+// arguments look like --name=value, anything unknown throws so typos dont silently do nothing
+void parseArguments(int argc, char **argv);
+
+}
+
+#endif
@@ -2,6 +2,8 @@
 #define SHADER_LOADING_HEADER
 #include <cstddef>
 #include <cstdint>
+#include "profiler.hpp"
+#include "trace.hpp"
 #include <fstream>
 #include <stdexcept>
 #include <vector>
@@ -9,6 +11,8 @@
 
 std::vector<char> readShaderFile(const std::string& filename)
 {
+	tprofile::Scope scope("read shader", tprofile::kind::fileIo);
+	TRACE_ZONE("read shader");
 	std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
 	if (!file.is_open()) {
@@ -32,7 +36,7 @@ VkShaderModule createShaderModule(const std::vector<char>& code, VkDevice logica
 	createInfo.codeSize = code.size();
 	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
 	VkShaderModule module;
-	if (vkCreateShaderModule(logicalDevice, &createInfo, nullptr, &module) != VK_SUCCESS) {
+	if (tprofile::timed("vkCreateShaderModule", vkCreateShaderModule, logicalDevice, &createInfo, nullptr, &module) != VK_SUCCESS) {
 		throw std::runtime_error("Failed to initialize shader module");
 	}
 	return module;
@@ -0,0 +1,21 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// same as shader.frag but the texture comes out of the bindless table in set 1
+layout(set = 1, binding = 0) uniform sampler textureSampler;
+layout(set = 1, binding = 1) uniform texture2D textures[];
+
+// the model matrix in front of this belongs to the vertex shader
+layout(push_constant) uniform DrawConstants {
+	layout(offset = 64) uint textureIndex;
+} draw;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+	// the index is the same for the whole draw, so no nonuniformEXT needed
+	outColor = texture(sampler2D(textures[draw.textureIndex], textureSampler), fragTexCoord);
+}
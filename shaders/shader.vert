@@ -1,10 +1,22 @@
 #version 450
 
-layout(binding = 0) uniform UniformBufferObject {
-	mat4 model;
+// set from the pipeline, true for --transforms=push and false for --transforms=dynamic
+layout(constant_id = 0) const bool MODEL_FROM_PUSH_CONSTANT = true;
+
+// same for every draw in a frame
+layout(set = 0, binding = 0) uniform CameraUniforms {
 	mat4 view;
 	mat4 proj;
-} ubo;
+} camera;
+
+// one slot per draw, picked with a dynamic offset when binding the set
+layout(set = 0, binding = 2) uniform ObjectUniforms {
+	mat4 model;
+} object;
+
+layout(push_constant) uniform DrawConstants {
+	mat4 model;
+} draw;
 
 //dont forget that some types are so THICC that they need multiple slots so index should increment by 2 in those cases (not here)
 layout(location = 0) in vec3 inPosition;
@@ -15,7 +27,8 @@ layout(location = 0) out vec3 fragColor;
 layout(location = 1) out vec2 fragTexCoord;
 
 void main() {
-	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+	mat4 model = MODEL_FROM_PUSH_CONSTANT ? draw.model : object.model;
+	gl_Position = camera.proj * camera.view * model * vec4(inPosition, 1.0);
 	fragColor = inColor;
 	fragTexCoord = inTexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef TRIANGLE_SPSC_QUEUE_HEADER
+#define TRIANGLE_SPSC_QUEUE_HEADER
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// bounded lock free ring buffer for exactly one producer thread and one consumer thread, neither side ever blocks.
+// each side keeps a stale copy of the other ones index and only reloads it when the ring looks full or empty, so
+// most pushes and pops dont touch the other threads cache line at all
+namespace tqueue {
+
+template <typename T, size_t Capacity> class SpscQueue {
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity has to be a power of two");
+
+      public:
+	// producer only, false when the ring is full and value was not added
+	bool push(const T &value)
+	{
+		size_t write = writeIndex.load(std::memory_order_relaxed);
+		if (write - cachedReadIndex == Capacity) {
+			cachedReadIndex = readIndex.load(std::memory_order_acquire);
+			if (write - cachedReadIndex == Capacity)
+				return false;
+		}
+		slots[write & (Capacity - 1)] = value;
+		writeIndex.store(write + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer only, false when there was nothing to take
+	bool pop(T &value)
+	{
+		size_t read = readIndex.load(std::memory_order_relaxed);
+		if (read == cachedWriteIndex) {
+			cachedWriteIndex = writeIndex.load(std::memory_order_acquire);
+			if (read == cachedWriteIndex)
+				return false;
+		}
+		value = slots[read & (Capacity - 1)];
+		readIndex.store(read + 1, std::memory_order_release);
+		return true;
+	}
+
+      private:
+	std::array<T, Capacity> slots;
+	// indices only ever go up, the slot is the index masked by the capacity
+	alignas(64) std::atomic<size_t> writeIndex{0};
+	size_t cachedReadIndex = 0; // producers copy of readIndex
+	alignas(64) std::atomic<size_t> readIndex{0};
+	size_t cachedWriteIndex = 0; // consumers copy of writeIndex
+};
+
+} // namespace tqueue
+
+#endif
@@ -0,0 +1,146 @@
+#include "stallAnalyzer.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+static const char *WAIT_NAMES[tstall::WAIT_KINDS] = {"frame slot", "acquire", "present"};
+static const char *BOUND_NAMES[tstall::BOUND_KINDS] = {"cpu", "gpu", "present"};
+static const double FIRST_BUCKET_MS = 0.016;
+
+// upper edge of a bucket, the last one has none
+static double bucketLimitMs(size_t bucket) { return FIRST_BUCKET_MS * static_cast<double>(1u << bucket); }
+
+void tstall::StallAnalyzer::histogram::add(double ms)
+{
+	size_t bucket = 0;
+	while (bucket + 1 < HISTOGRAM_BUCKETS && ms >= bucketLimitMs(bucket)) {
+		++bucket;
+	}
+	++counts[bucket];
+}
+
+void tstall::StallAnalyzer::frameStart()
+{
+	auto now = std::chrono::steady_clock::now();
+	if (started)
+		finishFrame(std::chrono::duration<double, std::milli>(now - currentStart).count());
+	started = true;
+	currentStart = now;
+	currentWaits = {};
+}
+
+void tstall::StallAnalyzer::addWait(wait kind, std::chrono::steady_clock::duration blocked)
+{
+	currentWaits[static_cast<size_t>(kind)] += std::chrono::duration<double, std::milli>(blocked).count();
+}
+
+void tstall::StallAnalyzer::finishFrame(double frameMs)
+{
+	double gpuMs = currentWaits[static_cast<size_t>(wait::frameSlot)];
+	double presentMs = currentWaits[static_cast<size_t>(wait::acquire)] + currentWaits[static_cast<size_t>(wait::present)];
+	double cpuMs = std::max(frameMs - gpuMs - presentMs, 0.0);
+	bound classifiedAs = bound::cpu;
+	if (gpuMs > cpuMs && gpuMs >= presentMs)
+		classifiedAs = bound::gpu;
+	else if (presentMs > cpuMs && presentMs > gpuMs)
+		classifiedAs = bound::present;
+
+	frame f{static_cast<float>(frameMs), {}, classifiedAs};
+	for (size_t i = 0; i < WAIT_KINDS; ++i) {
+		f.waitMs[i] = static_cast<float>(currentWaits[i]);
+		waitHistograms[i].add(currentWaits[i]);
+		intervalWaitSums[i] += currentWaits[i];
+		intervalWaitMax[i] = std::max(intervalWaitMax[i], currentWaits[i]);
+	}
+	frameHistogram.add(frameMs);
+	++frameCount;
+	++boundCounts[static_cast<size_t>(classifiedAs)];
+	++intervalFrames;
+	intervalFrameSum += frameMs;
+	++intervalBounds[static_cast<size_t>(classifiedAs)];
+
+	if (rows.size() < FRAME_ROWS) {
+		rows.push_back(f);
+	} else {
+		rows[nextRow] = f;
+		nextRow = (nextRow + 1) % FRAME_ROWS;
+	}
+}
+
+void tstall::StallAnalyzer::logLine(std::ostream &out)
+{
+	size_t count = intervalFrames;
+	if (count == 0)
+		return;
+	out << std::fixed << std::setprecision(3) << "stalls (" << count << " frames): " << intervalFrameSum / count << " ms frame";
+	for (size_t w = 0; w < WAIT_KINDS; ++w) {
+		out << ", " << WAIT_NAMES[w] << " " << intervalWaitSums[w] / count << " avg " << intervalWaitMax[w] << " max";
+	}
+	out << " ms. bound by";
+	for (size_t b = 0; b < BOUND_KINDS; ++b) {
+		out << (b == 0 ? " " : ", ") << BOUND_NAMES[b] << " " << intervalBounds[b];
+	}
+	out << std::endl << std::defaultfloat << std::setprecision(6);
+	intervalFrames = 0;
+	intervalFrameSum = 0.0;
+	intervalWaitSums = {};
+	intervalWaitMax = {};
+	intervalBounds = {};
+}
+
+void tstall::StallAnalyzer::printSummary(std::ostream &out) const
+{
+	out << "stall summary, " << frameCount << " frames:";
+	for (size_t b = 0; b < BOUND_KINDS; ++b) {
+		double share = frameCount == 0 ? 0.0 : 100.0 * boundCounts[b] / frameCount;
+		out << (b == 0 ? " " : ", ") << BOUND_NAMES[b] << " bound " << boundCounts[b] << " (" << std::fixed << std::setprecision(1) << share << "%)";
+	}
+	out << std::endl << std::defaultfloat << std::setprecision(6);
+}
+
+void tstall::StallAnalyzer::writeJson(const std::string &path) const
+{
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error(std::string("failed to open ").append(path));
+	}
+	auto writeHistogram = [&file](const histogram &h) {
+		file << "[";
+		for (size_t i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+			file << (i == 0 ? "" : ", ") << h.counts[i];
+		}
+		file << "]";
+	};
+
+	file << "{\n  \"frames\": " << frameCount << ",\n  \"bound\": {";
+	for (size_t b = 0; b < BOUND_KINDS; ++b) {
+		file << (b == 0 ? "" : ", ") << "\"" << BOUND_NAMES[b] << "\": " << boundCounts[b];
+	}
+	// counts[i] are the samples below bucketUpperMs[i] and at or above the one before, the last bucket has no upper edge
+	file << "},\n  \"bucketUpperMs\": [";
+	for (size_t i = 0; i + 1 < HISTOGRAM_BUCKETS; ++i) {
+		file << (i == 0 ? "" : ", ") << bucketLimitMs(i);
+	}
+	file << "],\n  \"histograms\": {\n    \"frame\": ";
+	writeHistogram(frameHistogram);
+	for (size_t w = 0; w < WAIT_KINDS; ++w) {
+		file << ",\n    \"" << WAIT_NAMES[w] << "\": ";
+		writeHistogram(waitHistograms[w]);
+	}
+	// rows are the last frames of the run oldest first, firstFrame is the index of the first one in the whole run
+	file << "\n  },\n  \"perFrame\": {\"firstFrame\": " << frameCount - rows.size() << ", \"columns\": [\"frameMs\"";
+	for (size_t w = 0; w < WAIT_KINDS; ++w) {
+		file << ", \"" << WAIT_NAMES[w] << " ms\"";
+	}
+	file << ", \"bound\"], \"rows\": [";
+	for (size_t i = 0; i < rows.size(); ++i) {
+		const frame &f = rows[(nextRow + i) % rows.size()];
+		file << (i == 0 ? "\n    [" : ",\n    [") << f.frameMs;
+		for (size_t w = 0; w < WAIT_KINDS; ++w) {
+			file << ", " << f.waitMs[w];
+		}
+		file << ", \"" << BOUND_NAMES[static_cast<size_t>(f.classifiedAs)] << "\"]";
+	}
+	file << "\n  ]}\n}\n";
+}
@@ -0,0 +1,74 @@
+#ifndef TRIANGLE_STALL_ANALYZER_HEADER
+#define TRIANGLE_STALL_ANALYZER_HEADER
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// where a frame spends its time blocked. the render loop reports how long each blocking call took, every frame is then
+// put down as bound by whatever took the most of it: waiting for its frame slot means the gpu is behind, acquire and
+// present blocking means presentation is, and anything else left over is the cpu's own work
+namespace tstall {
+
+enum class wait { frameSlot, acquire, present };
+const size_t WAIT_KINDS = 3;
+
+enum class bound { cpu, gpu, present };
+const size_t BOUND_KINDS = 3;
+
+// histogram buckets double from 16 us up, the last one takes everything past 64 ms
+const size_t HISTOGRAM_BUCKETS = 14;
+// per frame rows kept for the json, older frames only live on in the histograms and bound counts
+const size_t FRAME_ROWS = 4096;
+
+class StallAnalyzer {
+      public:
+	// once at the start of every frame, closes the previous one. waits of a frame that returned early (swapchain
+	// recreation) end up in the next one
+	void frameStart();
+	void addWait(wait kind, std::chrono::steady_clock::duration blocked);
+
+	// averages and bound counts since the last log line
+	void logLine(std::ostream &out);
+	// the whole run: bound counts, histograms of the frame time and every wait, then the last FRAME_ROWS frames
+	void writeJson(const std::string &path) const;
+	void printSummary(std::ostream &out) const;
+
+      private:
+	struct frame {
+		float frameMs;
+		std::array<float, WAIT_KINDS> waitMs;
+		bound classifiedAs;
+	};
+	struct histogram {
+		std::array<uint32_t, HISTOGRAM_BUCKETS> counts{};
+		void add(double ms);
+	};
+
+	void finishFrame(double frameMs);
+
+	bool started = false;
+	std::chrono::steady_clock::time_point currentStart;
+	std::array<double, WAIT_KINDS> currentWaits{};
+	// whole run
+	uint64_t frameCount = 0;
+	std::array<uint64_t, BOUND_KINDS> boundCounts{};
+	histogram frameHistogram;
+	std::array<histogram, WAIT_KINDS> waitHistograms;
+	// ring of the last FRAME_ROWS frames, once full nextRow is the oldest
+	std::vector<frame> rows;
+	size_t nextRow = 0;
+	// since the last log line
+	size_t intervalFrames = 0;
+	double intervalFrameSum = 0.0;
+	std::array<double, WAIT_KINDS> intervalWaitSums{};
+	std::array<double, WAIT_KINDS> intervalWaitMax{};
+	std::array<uint32_t, BOUND_KINDS> intervalBounds{};
+};
+
+} // namespace tstall
+
+#endif
@@ -0,0 +1,122 @@
+#include "taskGraph.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+// width of the bars in printTimeline
+static const int TIMELINE_COLUMNS = 60;
+
+tjobs::TaskGraph::taskHandle tjobs::TaskGraph::add(const std::string &name, std::vector<taskHandle> dependencies, std::function<void()> work)
+{
+	taskHandle handle = static_cast<taskHandle>(tasks.size());
+	for (taskHandle dependency : dependencies) {
+		if (dependency >= handle)
+			throw std::invalid_argument(name + " depends on a task that was added after it");
+	}
+	auto added = std::make_unique<task>();
+	added->name = name;
+	added->dependencies = std::move(dependencies);
+	added->work = std::move(work);
+	for (taskHandle dependency : added->dependencies) {
+		tasks[dependency]->dependents.push_back(handle);
+	}
+	tasks.push_back(std::move(added));
+	return handle;
+}
+
+void tjobs::TaskGraph::execute(JobSystem &jobs, taskHandle handle)
+{
+	task &t = *tasks[handle];
+	t.worker = jobs.currentWorker();
+	t.start = std::chrono::steady_clock::now();
+	{
+		tprofile::Scope scope(t.name.c_str(), tprofile::kind::stage);
+		t.work();
+	}
+	t.end = std::chrono::steady_clock::now();
+}
+
+void tjobs::TaskGraph::spawn(JobSystem &jobs, Counter &counter, taskHandle handle)
+{
+	jobs.run(counter, [this, &jobs, &counter, handle] {
+		// a task that throws never gets here, so nothing after it starts
+		execute(jobs, handle);
+		for (taskHandle dependent : tasks[handle]->dependents) {
+			if (tasks[dependent]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				spawn(jobs, counter, dependent);
+		}
+	});
+}
+
+void tjobs::TaskGraph::run(JobSystem &jobs, bool serial)
+{
+	ranSerially = serial;
+	runStart = std::chrono::steady_clock::now();
+	if (serial) {
+		for (taskHandle handle = 0; handle < tasks.size(); ++handle) {
+			execute(jobs, handle);
+		}
+	} else {
+		for (auto &t : tasks) {
+			t->remaining = static_cast<uint32_t>(t->dependencies.size());
+		}
+		Counter counter;
+		for (taskHandle handle = 0; handle < tasks.size(); ++handle) {
+			if (tasks[handle]->dependencies.empty())
+				spawn(jobs, counter, handle);
+		}
+		jobs.wait(counter);
+	}
+	runEnd = std::chrono::steady_clock::now();
+}
+
+void tjobs::TaskGraph::printTimeline(std::ostream &out) const
+{
+	auto ms = [this](std::chrono::steady_clock::time_point time) { return std::chrono::duration<double, std::milli>(time - runStart).count(); };
+	double total = std::max(ms(runEnd), 1e-3);
+
+	// longest chain of dependencies by measured task time, the order of adds is a topological order so one pass does it.
+	// thats as fast as startup can get with these tasks however many workers there are
+	std::vector<double> chainMs(tasks.size(), 0.0);
+	std::vector<taskHandle> previous(tasks.size());
+	taskHandle last = 0;
+	for (taskHandle handle = 0; handle < tasks.size(); ++handle) {
+		const task &t = *tasks[handle];
+		previous[handle] = handle;
+		for (taskHandle dependency : t.dependencies) {
+			if (chainMs[dependency] > chainMs[handle]) {
+				chainMs[handle] = chainMs[dependency];
+				previous[handle] = dependency;
+			}
+		}
+		chainMs[handle] += ms(t.end) - ms(t.start);
+		if (chainMs[handle] > chainMs[last])
+			last = handle;
+	}
+	std::vector<bool> critical(tasks.size(), false);
+	double criticalMs = tasks.empty() ? 0.0 : chainMs[last];
+	for (bool more = !tasks.empty(); more; last = previous[last]) {
+		critical[last] = true;
+		more = previous[last] != last;
+	}
+
+	size_t nameWidth = 0;
+	for (auto &t : tasks) {
+		nameWidth = std::max(nameWidth, t->name.size());
+	}
+	out << "startup (" << (ranSerially ? "serial" : "task graph") << "): " << std::fixed << std::setprecision(1) << total << " ms, critical path "
+	    << criticalMs << " ms, * marks it" << std::endl;
+	for (taskHandle handle = 0; handle < tasks.size(); ++handle) {
+		const task &t = *tasks[handle];
+		double start = ms(t.start);
+		double end = ms(t.end);
+		int firstColumn = std::min(static_cast<int>(start / total * TIMELINE_COLUMNS), TIMELINE_COLUMNS - 1);
+		int lastColumn = std::min(std::max(firstColumn + 1, static_cast<int>(end / total * TIMELINE_COLUMNS)), TIMELINE_COLUMNS);
+		std::string bar(TIMELINE_COLUMNS, ' ');
+		bar.replace(firstColumn, lastColumn - firstColumn, lastColumn - firstColumn, '#');
+		out << (critical[handle] ? "* " : "  ") << std::left << std::setw(static_cast<int>(nameWidth)) << t.name << std::right << " |" << bar << "| "
+		    << std::setw(7) << start << " +" << std::setw(7) << end - start << " ms, worker " << t.worker << std::endl;
+	}
+	out << std::defaultfloat << std::setprecision(6);
+}
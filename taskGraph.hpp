@@ -0,0 +1,51 @@
+#ifndef TRIANGLE_TASK_GRAPH_HEADER
+#define TRIANGLE_TASK_GRAPH_HEADER
+
+#include "jobSystem.hpp"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// one shot graph of named tasks on top of the job system, every task starts as soon as the ones it depends on are done.
+// meant for startup: run it once, then print the timeline to see what actually overlapped and what the critical path was
+namespace tjobs {
+
+class TaskGraph {
+      public:
+	using taskHandle = uint32_t;
+
+	// dependencies have to be added before the tasks that need them, so the order of adds is always a valid serial order
+	taskHandle add(const std::string &name, std::vector<taskHandle> dependencies, std::function<void()> work);
+
+	// runs every task once, serial runs them one after another in the order they were added on the calling thread.
+	// the first exception thrown by a task is rethrown after everything that didnt depend on it has finished
+	void run(JobSystem &jobs, bool serial);
+
+	// start and duration of every task plus the chain of dependencies that finished last
+	void printTimeline(std::ostream &out) const;
+
+      private:
+	struct task {
+		std::string name;
+		std::vector<taskHandle> dependencies;
+		std::vector<taskHandle> dependents;
+		std::function<void()> work;
+		std::atomic<uint32_t> remaining{0};
+		std::chrono::steady_clock::time_point start, end;
+		uint32_t worker = 0;
+	};
+
+	void execute(JobSystem &jobs, taskHandle handle);
+	void spawn(JobSystem &jobs, Counter &counter, taskHandle handle);
+
+	std::vector<std::unique_ptr<task>> tasks;
+	std::chrono::steady_clock::time_point runStart, runEnd;
+	bool ranSerially = false;
+};
+
+} // namespace tjobs
+
+#endif
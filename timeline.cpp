@@ -0,0 +1,72 @@
+#include "timeline.hpp"
+#include "profiler.hpp"
+#include <stdexcept>
+
+static PFN_vkWaitSemaphoresKHR waitSemaphores = nullptr;
+static PFN_vkGetSemaphoreCounterValueKHR getSemaphoreCounterValue = nullptr;
+
+void ttimeline::loadFunctions(VkDevice device)
+{
+	waitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+	getSemaphoreCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR");
+	if (waitSemaphores == nullptr || getSemaphoreCounterValue == nullptr) {
+		throw std::runtime_error("Failed to load VK_KHR_timeline_semaphore functions");
+	}
+}
+
+void ttimeline::Timeline::create(VkDevice device)
+{
+	VkSemaphoreTypeCreateInfoKHR typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	createInfo.pNext = &typeInfo;
+	if (tprofile::timed("vkCreateSemaphore", vkCreateSemaphore, device, &createInfo, nullptr, &semaphore) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to create timeline semaphore");
+	}
+	lastReserved = 0;
+	completed = 0;
+}
+
+void ttimeline::Timeline::destroy(VkDevice device)
+{
+	vkDestroySemaphore(device, semaphore, nullptr);
+	semaphore = VK_NULL_HANDLE;
+}
+
+bool ttimeline::Timeline::reached(VkDevice device, uint64_t value)
+{
+	if (value <= completed)
+		return true;
+	if (getSemaphoreCounterValue(device, semaphore, &completed) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to read timeline semaphore value");
+	}
+	return value <= completed;
+}
+
+uint64_t ttimeline::Timeline::completedValue(VkDevice device)
+{
+	// nothing newer was submitted, no need to ask
+	if (completed < lastReserved && getSemaphoreCounterValue(device, semaphore, &completed) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to read timeline semaphore value");
+	}
+	return completed;
+}
+
+void ttimeline::Timeline::wait(VkDevice device, uint64_t value)
+{
+	if (value <= completed)
+		return;
+	VkSemaphoreWaitInfoKHR waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore;
+	waitInfo.pValues = &value;
+	if (waitSemaphores(device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+		throw std::runtime_error("Failed to wait for timeline semaphore");
+	}
+	completed = value;
+}
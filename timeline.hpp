@@ -0,0 +1,39 @@
+#ifndef TRIANGLE_TIMELINE_HEADER
+#define TRIANGLE_TIMELINE_HEADER
+
+#include <cstdint>
+#include <vulkan/vulkan_core.h>
+
+// VK_KHR_timeline_semaphore wrapper. a timeline is one semaphore with a counter that only goes up, every submit
+// signals the next value and anything that has to wait for that submit (cpu or gpu) waits for the value instead
+// of needing its own fence
+namespace ttimeline {
+
+// the KHR entry points arent exported by the loader, call this once after creating a device with the extension
+void loadFunctions(VkDevice device);
+
+class Timeline {
+      public:
+	void create(VkDevice device);
+	void destroy(VkDevice device);
+	VkSemaphore handle() const { return semaphore; }
+
+	// value the next submit should signal, values have to be signalled in the order they were reserved
+	uint64_t reserve() { return ++lastReserved; }
+	// value of the newest submit, waiting for it waits for everything submitted on this timeline so far
+	uint64_t lastSignalValue() const { return lastReserved; }
+	// non blocking check, 0 is always reached
+	bool reached(VkDevice device, uint64_t value);
+	// counter value right now, everything signalled up to it is done
+	uint64_t completedValue(VkDevice device);
+	void wait(VkDevice device, uint64_t value);
+
+      private:
+	VkSemaphore semaphore = VK_NULL_HANDLE;
+	uint64_t lastReserved = 0;
+	uint64_t completed = 0; // last counter value read back from the device, saves asking again for older values
+};
+
+} // namespace ttimeline
+
+#endif
@@ -0,0 +1,173 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+enum eventType : uint32_t { zoneEvent, counterEvent };
+
+// every field is atomic so write can copy a slot the owner is overwriting, it finds out from head and drops the copy
+struct event {
+	std::atomic<const char *> name{nullptr};
+	std::atomic<uint64_t> begin{0};
+	std::atomic<uint64_t> value{0}; // end time for zones, bits of the double for counters
+	std::atomic<uint32_t> type{zoneEvent};
+};
+
+struct ring {
+	uint32_t threadId = 0;
+	std::string threadName; // guarded by registryMutex
+	// events ever recorded, slot is head % RING_CAPACITY. only the owning thread stores it
+	std::atomic<uint64_t> head{0};
+	std::vector<event> events = std::vector<event>(ttrace::RING_CAPACITY);
+};
+
+std::atomic<bool> recording{false};
+const auto epoch = std::chrono::steady_clock::now();
+std::mutex registryMutex;
+// shared with the owning threads, rings of threads that already exited still get written out
+std::vector<std::shared_ptr<ring>> rings;
+thread_local std::shared_ptr<ring> ownRing;
+
+ring &threadRing()
+{
+	if (!ownRing) {
+		auto created = std::make_shared<ring>();
+		std::lock_guard<std::mutex> lock(registryMutex);
+		created->threadId = static_cast<uint32_t>(rings.size());
+		rings.push_back(created);
+		ownRing = created;
+	}
+	return *ownRing;
+}
+
+void record(const char *name, uint64_t begin, uint64_t value, eventType type)
+{
+	ring &r = threadRing();
+	uint64_t index = r.head.load(std::memory_order_relaxed);
+	event &slot = r.events[index % ttrace::RING_CAPACITY];
+	// seqlock style: a reader that sees any of the stores below also sees head at index or later, so it knows the slot changed
+	std::atomic_thread_fence(std::memory_order_release);
+	slot.name.store(name, std::memory_order_relaxed);
+	slot.begin.store(begin, std::memory_order_relaxed);
+	slot.value.store(value, std::memory_order_relaxed);
+	slot.type.store(type, std::memory_order_relaxed);
+	r.head.store(index + 1, std::memory_order_release);
+}
+
+struct copiedEvent {
+	const char *name;
+	uint64_t begin;
+	uint64_t value;
+	uint32_t type;
+};
+
+// the events of one ring that were not overwritten while they were being copied
+std::vector<copiedEvent> copyRing(const ring &r)
+{
+	uint64_t end = r.head.load(std::memory_order_acquire);
+	uint64_t begin = end > ttrace::RING_CAPACITY ? end - ttrace::RING_CAPACITY : 0;
+	std::vector<copiedEvent> copied;
+	copied.reserve(static_cast<size_t>(end - begin));
+	for (uint64_t index = begin; index < end; ++index) {
+		const event &slot = r.events[index % ttrace::RING_CAPACITY];
+		copied.push_back({slot.name.load(std::memory_order_relaxed), slot.begin.load(std::memory_order_relaxed),
+				  slot.value.load(std::memory_order_relaxed), slot.type.load(std::memory_order_relaxed)});
+	}
+	std::atomic_thread_fence(std::memory_order_acquire);
+	// the owner writes slot head % capacity before moving head, so index head - capacity may be half written too
+	uint64_t after = r.head.load(std::memory_order_relaxed);
+	uint64_t firstIntact = after >= ttrace::RING_CAPACITY ? after - ttrace::RING_CAPACITY + 1 : 0;
+	if (firstIntact > begin)
+		copied.erase(copied.begin(), copied.begin() + static_cast<ptrdiff_t>(std::min(firstIntact - begin, end - begin)));
+	return copied;
+}
+
+std::string jsonString(const char *value)
+{
+	std::string quoted = "\"";
+	for (const char *c = value; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\')
+			quoted += '\\';
+		quoted += *c;
+	}
+	return quoted + "\"";
+}
+
+} // namespace
+
+void ttrace::enable() { recording = true; }
+
+bool ttrace::enabled() { return recording.load(std::memory_order_relaxed); }
+
+void ttrace::nameThread(const std::string &name)
+{
+	ring &r = threadRing();
+	std::lock_guard<std::mutex> lock(registryMutex);
+	r.threadName = name;
+}
+
+uint64_t ttrace::now()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+void ttrace::zone(const char *name, uint64_t beginNanoseconds, uint64_t endNanoseconds) { record(name, beginNanoseconds, endNanoseconds, zoneEvent); }
+
+void ttrace::counter(const char *name, double value)
+{
+	uint64_t bits;
+	static_assert(sizeof(bits) == sizeof(value), "counters store the double in a uint64_t");
+	std::memcpy(&bits, &value, sizeof(bits));
+	record(name, now(), bits, counterEvent);
+}
+
+void ttrace::write(const std::string &path)
+{
+	std::vector<std::shared_ptr<ring>> snapshot;
+	std::vector<std::string> names;
+	{
+		std::lock_guard<std::mutex> lock(registryMutex);
+		snapshot = rings;
+		for (auto &r : rings) {
+			names.push_back(r->threadName);
+		}
+	}
+	std::ofstream file(path);
+	if (!file.is_open()) {
+		throw std::runtime_error(std::string("failed to open ").append(path));
+	}
+	// chrome wants microseconds, three decimals keeps the nanoseconds
+	file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+	bool first = true;
+	auto separator = [&first] {
+		const char *s = first ? "" : ",\n";
+		first = false;
+		return s;
+	};
+	for (size_t i = 0; i < snapshot.size(); ++i) {
+		const ring &r = *snapshot[i];
+		if (!names[i].empty()) {
+			file << separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << r.threadId
+			     << ", \"args\": {\"name\": " << jsonString(names[i].c_str()) << "}}";
+		}
+		for (const copiedEvent &e : copyRing(r)) {
+			file << separator() << "{\"name\": " << jsonString(e.name) << ", \"pid\": 1, \"tid\": " << r.threadId << ", \"ts\": " << e.begin * 1e-3;
+			if (e.type == zoneEvent) {
+				file << ", \"ph\": \"X\", \"dur\": " << (e.value - e.begin) * 1e-3 << "}";
+			} else {
+				double value;
+				std::memcpy(&value, &e.value, sizeof(value));
+				file << ", \"ph\": \"C\", \"args\": {\"value\": " << value << "}}";
+			}
+		}
+	}
+	file << "\n]}\n";
+}
@@ -0,0 +1,69 @@
+#ifndef TRIANGLE_TRACE_HEADER
+#define TRIANGLE_TRACE_HEADER
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// cpu zones and counters for looking at frames in chrome://tracing or ui.perfetto.dev. every thread records into its
+// own ring buffer, recording never locks and never allocates after the first event on a thread, the oldest events
+// get overwritten once a ring is full. write can run from any thread while the others keep recording.
+// building without TRIANGLE_TRACE_ENABLED turns TRACE_ZONE and TRACE_COUNTER into nothing
+namespace ttrace {
+
+// events a thread keeps before it starts overwriting its oldest ones
+const uint32_t RING_CAPACITY = 1 << 15;
+
+// nothing gets recorded until this is called
+void enable();
+bool enabled();
+
+// shows up as the thread name in the viewer, the calling thread gets a ring if it didnt have one
+void nameThread(const std::string &name);
+
+// names have to outlive the trace, string literals only
+void zone(const char *name, uint64_t beginNanoseconds, uint64_t endNanoseconds);
+void counter(const char *name, double value);
+uint64_t now();
+
+// every ring as chrome trace event json, which perfetto opens as well
+void write(const std::string &path);
+
+class Zone {
+      public:
+	explicit Zone(const char *name) : name(enabled() ? name : nullptr), begin(this->name ? now() : 0) {}
+	~Zone()
+	{
+		if (name)
+			zone(name, begin, now());
+	}
+	Zone(const Zone &) = delete;
+	Zone &operator=(const Zone &) = delete;
+
+      private:
+	const char *name;
+	uint64_t begin;
+};
+
+} // namespace ttrace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef TRIANGLE_TRACE_ENABLED
+#define TRACE_ZONE(name) ttrace::Zone TRACE_CONCAT(traceZone, __LINE__)(name)
+#define TRACE_COUNTER(name, value)                                                                                                                   \
+	do {                                                                                                                                         \
+		if (ttrace::enabled())                                                                                                               \
+			ttrace::counter(name, static_cast<double>(value));                                                                           \
+	} while (0)
+#else
+#define TRACE_ZONE(name)                                                                                                                             \
+	do {                                                                                                                                         \
+	} while (0)
+#define TRACE_COUNTER(name, value)                                                                                                                   \
+	do {                                                                                                                                         \
+	} while (0)
+#endif
+
+#endif